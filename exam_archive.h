@@ -0,0 +1,206 @@
+/**
+ * @file exam_archive.h
+ * @brief Packed exam archive: one file holding every exam for a marking run
+ * @author Student 1: Bhagya Patel (101324150)
+ * @author Student 2: Oluwatobi Olowookere (101245900)
+ *
+ * Layout (native byte order):
+ *   ExamArchiveHeader
+ *   ExamArchiveEntry[num_exams]   index, sorted by student number with the
+ *                                 termination exam(s) last
+ *   exam bodies                   the original exam_*.txt contents, back to back
+ *
+ * The engines mmap the archive once before forking, so loading an exam is a
+ * memcpy out of the mapping instead of an open/read/close per file.
+ */
+#ifndef EXAM_ARCHIVE_H
+#define EXAM_ARCHIVE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define EXAM_ARCHIVE_MAGIC "TAEXAMS"
+#define EXAM_ARCHIVE_VERSION 1
+#define EXAM_FLAG_SENTINEL 0x1  // Loading this exam ends the run (student 9999)
+
+struct ExamArchiveHeader {
+    char magic[8];           // EXAM_ARCHIVE_MAGIC, NUL padded
+    uint32_t version;        // EXAM_ARCHIVE_VERSION
+    uint32_t num_exams;      // Entries in the index
+    uint64_t index_offset;   // Offset of the first ExamArchiveEntry
+    uint64_t bodies_offset;  // Offset of the first exam body
+    uint64_t file_size;      // Total archive size, for validation
+};
+
+struct ExamArchiveEntry {
+    int32_t student_number;
+    uint32_t flags;          // EXAM_FLAG_*
+    uint64_t offset;         // Offset of the body from the start of the archive
+    uint32_t length;         // Body length in bytes (not NUL terminated)
+    uint32_t reserved;
+};
+
+// A read-only mapping of an archive
+struct ExamArchive {
+    const char* base;
+    size_t size;
+    const ExamArchiveHeader* header;
+    const ExamArchiveEntry* entries;
+};
+
+// Map an archive and check its header and index. Returns false on error.
+inline bool open_exam_archive(const char* path, ExamArchive& archive) {
+    memset(&archive, 0, sizeof(archive));
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror(path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(ExamArchiveHeader)) {
+        std::cerr << "Error: " << path << " is too small to be an exam archive\n";
+        close(fd);
+        return false;
+    }
+
+    void* base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    archive.base = (const char*)base;
+    archive.size = st.st_size;
+    archive.header = (const ExamArchiveHeader*)base;
+
+    const ExamArchiveHeader* header = archive.header;
+    bool valid = strncmp(header->magic, EXAM_ARCHIVE_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->version == EXAM_ARCHIVE_VERSION &&
+                 header->file_size == archive.size &&
+                 header->index_offset + (uint64_t)header->num_exams * sizeof(ExamArchiveEntry)
+                     <= archive.size;
+    if (valid) {
+        archive.entries = (const ExamArchiveEntry*)(archive.base + header->index_offset);
+        for (uint32_t i = 0; i < header->num_exams && valid; i++) {
+            valid = archive.entries[i].offset + archive.entries[i].length <= archive.size;
+        }
+    }
+
+    if (!valid) {
+        std::cerr << "Error: " << path << " is not a valid exam archive\n";
+        munmap(base, archive.size);
+        memset(&archive, 0, sizeof(archive));
+        return false;
+    }
+    return true;
+}
+
+inline void close_exam_archive(ExamArchive& archive) {
+    if (archive.base != nullptr) {
+        munmap((void*)archive.base, archive.size);
+    }
+    memset(&archive, 0, sizeof(archive));
+}
+
+// Pack every exam_*.txt in a directory into one archive.
+// Returns the number of exams packed, or -1 on error.
+inline long pack_exam_directory(const std::string& dir, const std::string& out_path) {
+    struct PackedExam {
+        ExamArchiveEntry entry;
+        std::string body;
+    };
+    std::vector<PackedExam> exams;
+
+    DIR* d = opendir(dir.c_str());
+    if (!d) {
+        perror(dir.c_str());
+        return -1;
+    }
+    struct dirent* dirent_entry;
+    while ((dirent_entry = readdir(d)) != nullptr) {
+        std::string filename = dirent_entry->d_name;
+        if (filename.find("exam_") != 0 || filename.find(".txt") == std::string::npos) {
+            continue;
+        }
+
+        std::ifstream file(dir + "/" + filename);
+        std::string content((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+        size_t first_newline = content.find('\n');
+        if (first_newline == std::string::npos) {
+            std::cerr << "Skipping " << filename << ": no student number\n";
+            continue;
+        }
+
+        PackedExam exam;
+        memset(&exam.entry, 0, sizeof(exam.entry));
+        exam.entry.student_number = atoi(content.substr(0, first_newline).c_str());
+        exam.entry.flags = exam.entry.student_number == 9999 ? EXAM_FLAG_SENTINEL : 0;
+        exam.entry.length = content.size();
+        exam.body = content;
+        exams.push_back(exam);
+    }
+    closedir(d);
+
+    // Student order, with the termination exam last so it is loaded last
+    std::sort(exams.begin(), exams.end(), [](const PackedExam& a, const PackedExam& b) {
+        bool a_sentinel = a.entry.flags & EXAM_FLAG_SENTINEL;
+        bool b_sentinel = b.entry.flags & EXAM_FLAG_SENTINEL;
+        if (a_sentinel != b_sentinel) return b_sentinel;
+        return a.entry.student_number < b.entry.student_number;
+    });
+
+    ExamArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    strncpy(header.magic, EXAM_ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = EXAM_ARCHIVE_VERSION;
+    header.num_exams = exams.size();
+    header.index_offset = sizeof(ExamArchiveHeader);
+    header.bodies_offset = header.index_offset + exams.size() * sizeof(ExamArchiveEntry);
+
+    uint64_t offset = header.bodies_offset;
+    for (auto& exam : exams) {
+        exam.entry.offset = offset;
+        offset += exam.entry.length;
+    }
+    header.file_size = offset;
+
+    // Write to a temporary file and rename so readers never see a partial archive
+    std::string tmp_path = out_path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot write " << tmp_path << "\n";
+        return -1;
+    }
+    out.write((const char*)&header, sizeof(header));
+    for (const auto& exam : exams) {
+        out.write((const char*)&exam.entry, sizeof(exam.entry));
+    }
+    for (const auto& exam : exams) {
+        out.write(exam.body.data(), exam.body.size());
+    }
+    out.close();
+    if (!out || rename(tmp_path.c_str(), out_path.c_str()) != 0) {
+        std::cerr << "Error: Failed to write " << out_path << "\n";
+        unlink(tmp_path.c_str());
+        return -1;
+    }
+    return exams.size();
+}
+
+#endif  // EXAM_ARCHIVE_H
@@ -0,0 +1,609 @@
+/**
+ * @file ta_marking_bench.cpp
+ * @brief Benchmark driver for the Part A and Part B marking engines
+ * @author Student 1: Bhagya Patel (101324150)
+ * @author Student 2: Oluwatobi Olowookere (101245900)
+ *
+ * Every variant of MarkingEngine (ta_marking_engine.h) is compiled into this
+ * binary from the same code and run in-process over a sweep of TA counts,
+ * corpus sizes and delay models: Part A (NoSync), Part B (SemaphoreSync) and
+ * the lock-free engine (AtomicSync), each also with an adaptive TA pool.
+ * part_a_acct adds race accounting to Part A so the work lost to its races is
+ * reported next to its throughput. Each corpus can be fed to the engines as
+ * exam_*.txt files or as a packed exam archive. Every run happens in a forked
+ * child inside a generated corpus directory so the rubric corrections and the
+ * /ta_marking_shm segment never leak between runs. Results are written as
+ * CSV; passing --baseline compares them against an earlier CSV and exits
+ * non-zero on a throughput regression.
+ *
+ * Build:
+ *   g++ -O2 -std=c++17 -o ta_marking_bench ta_marking_bench.cpp -lrt -lpthread
+ */
+#define TA_MARKING_BENCH
+
+// Synthetic exams are ~250 bytes, so the slots can be much smaller than the
+// 4 KB the engines use by default. MAX_EXAMS has room for 1M exams plus the
+// student 9999 sentinel.
+#ifndef MAX_EXAM_SIZE
+#define MAX_EXAM_SIZE 512
+#endif
+#ifndef MAX_EXAMS
+#define MAX_EXAMS 1000001
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <atomic>
+#include <type_traits>
+#include <unistd.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <cerrno>
+#include <random>
+#include <dirent.h>
+#include <algorithm>
+
+#include "ta_marking_bench.h"
+#include "ta_marking_common.h"
+#include "exam_archive.h"
+#include "ta_stats.h"
+
+BenchStats* g_bench_stats = nullptr;
+
+// Multiplier applied to every sleep in the engines (0 = no simulated delay)
+static double g_delay_scale = 1.0;
+
+// Sleep replacement for the engines: scales the simulated work, and yields
+// instead of sleeping when the delay model is "zero"
+int bench_usleep(useconds_t usec) {
+    useconds_t scaled = (useconds_t)(usec * g_delay_scale);
+    if (scaled == 0) {
+        sched_yield();
+        return 0;
+    }
+    return usleep(scaled);
+}
+
+// sem_wait() replacement for the engines: counts how often a lock was
+// already held by someone else when we asked for it
+int bench_sem_wait(sem_t* sem) {
+    if (g_bench_stats != nullptr) {
+        g_bench_stats->lock_acquires++;
+    }
+    if (sem_trywait(sem) == 0) {
+        return 0;
+    }
+    if (g_bench_stats != nullptr) {
+        g_bench_stats->lock_waits++;
+    }
+    int rc;
+    while ((rc = sem_wait(sem)) == -1 && errno == EINTR) {
+    }
+    return rc;
+}
+
+// sem_trywait() replacement: a successful try is an acquire that never waited
+int bench_sem_trywait(sem_t* sem) {
+    int rc = sem_trywait(sem);
+    if (rc == 0 && g_bench_stats != nullptr) {
+        g_bench_stats->lock_acquires++;
+    }
+    return rc;
+}
+
+#define usleep bench_usleep
+#define sem_wait bench_sem_wait
+#define sem_trywait bench_sem_trywait
+
+#include "ta_marking_engine.h"
+
+#undef usleep
+#undef sem_wait
+#undef sem_trywait
+
+#define STUDENT_BASE 10000
+#define SENTINEL_FILE "exam_9999999.txt"
+#define ARCHIVE_FILE "exams.archive"
+
+static const char* DEFAULT_RUBRIC = "1, A\n2, B\n3, C\n4, D\n5, E\n";
+
+typedef MarkingEngine<NoSync, NUM_QUESTIONS> PartA;
+typedef MarkingEngine<RaceAccounted<NoSync>, NUM_QUESTIONS> PartAAcct;
+typedef MarkingEngine<SemaphoreSync, NUM_QUESTIONS> PartB;
+typedef MarkingEngine<AtomicSync, NUM_QUESTIONS> LockFree;
+
+// An engine with a fixed pool, and with an adaptive pool of 1..num_tas TAs
+template <class E>
+int run_fixed(int num_tas, const char* archive_path) {
+    return E::run_marking_system(num_tas, num_tas, archive_path);
+}
+
+template <class E>
+int run_adaptive(int num_tas, const char* archive_path) {
+    return E::run_marking_system(1, num_tas, archive_path);
+}
+
+struct Engine {
+    const char* name;
+    int (*run)(int num_tas, const char* archive_path);
+};
+
+static const Engine ENGINES[] = {
+    {"part_a", run_fixed<PartA>},
+    {"part_a_acct", run_fixed<PartAAcct>},
+    {"part_b", run_fixed<PartB>},
+    {"part_b_adaptive", run_adaptive<PartB>},
+    {"lockfree", run_fixed<LockFree>},
+    {"lockfree_adaptive", run_adaptive<LockFree>},
+};
+
+// Policy of CSV rows from before every engine took one ("-" was Part A's)
+#define DEFAULT_POLICY "finish_first"
+
+
+struct DelayModel {
+    std::string name;
+    double scale;
+};
+
+struct BenchResult {
+    std::string status;
+    double wall_s;
+    long questions;
+    long remarks;
+    double throughput;
+    double p50_ms;
+    double p99_ms;
+    double exam_p50_ms;
+    double exam_p99_ms;
+    long lock_acquires;
+    long lock_waits;
+    long max_rss_kb;
+    RaceCounts race;
+};
+
+struct BenchConfig {
+    std::vector<std::string> engines;
+    std::vector<int> tas;
+    std::vector<int> exams;
+    std::vector<DelayModel> delays;
+    std::vector<std::string> inputs;
+    std::vector<std::string> policies;
+    std::string workdir;
+    std::string out_file;
+    std::string baseline_file;
+    double tolerance;
+    double timeout_s;
+};
+
+// Split a comma separated list
+std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> items;
+    std::istringstream iss(s);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+std::vector<int> parse_int_list(const std::string& s) {
+    std::vector<int> values;
+    for (const auto& item : split_list(s)) {
+        values.push_back(atoi(item.c_str()));
+    }
+    return values;
+}
+
+// Delay models: "zero", "original" or "scale:<factor>"
+bool parse_delay_model(const std::string& s, DelayModel& model) {
+    model.name = s;
+    if (s == "zero") {
+        model.scale = 0.0;
+    } else if (s == "original") {
+        model.scale = 1.0;
+    } else if (s.find("scale:") == 0) {
+        model.scale = atof(s.c_str() + 6);
+        if (model.scale < 0.0) return false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const Engine* find_engine(const std::string& name) {
+    for (const auto& engine : ENGINES) {
+        if (name == engine.name) {
+            return &engine;
+        }
+    }
+    return nullptr;
+}
+
+// Generate (or reuse) a corpus directory with num_exams exams and the sentinel
+std::string prepare_corpus(const std::string& workdir, int num_exams) {
+    std::string dir = workdir + "/corpus_" + std::to_string(num_exams);
+    std::string sentinel = dir + "/" + SENTINEL_FILE;
+
+    struct stat st;
+    if (stat(sentinel.c_str(), &st) == 0) {
+        return dir;
+    }
+
+    mkdir(workdir.c_str(), 0755);
+    mkdir(dir.c_str(), 0755);
+    std::cerr << "Generating corpus of " << num_exams << " exams in " << dir << "\n";
+
+    char filename[64];
+    for (int i = 0; i < num_exams; i++) {
+        int student_num = STUDENT_BASE + i;
+        snprintf(filename, sizeof(filename), "/exam_%07d.txt", i);
+        std::ofstream file(dir + filename);
+        file << student_num << "\n";
+        for (int q = 1; q <= NUM_QUESTIONS; q++) {
+            file << "Question " << q << ": Student " << student_num << " answer for Q" << q << "\n";
+        }
+    }
+
+    // Written last so a half-generated corpus is regenerated next time
+    std::ofstream file(sentinel);
+    file << "9999\n";
+    for (int q = 1; q <= NUM_QUESTIONS; q++) {
+        file << "Question " << q << ": Final exam\n";
+    }
+    return dir;
+}
+
+double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0.0;
+    size_t idx = (size_t)(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + idx, samples.end());
+    return samples[idx];
+}
+
+// Pack a corpus directory into an archive (once) for the "archive" input
+bool prepare_archive(const std::string& corpus) {
+    std::string archive = corpus + "/" + ARCHIVE_FILE;
+    struct stat st;
+    if (stat(archive.c_str(), &st) == 0) {
+        return true;
+    }
+    return pack_exam_directory(corpus, archive) >= 0;
+}
+
+// Run one engine once in a forked child and collect its statistics
+BenchResult run_once(const Engine& engine, int num_tas, const std::string& corpus,
+                     const std::string& input, const std::string& policy,
+                     const DelayModel& delay, double timeout_s) {
+    BenchResult result = {};
+    g_bench_stats->questions_marked = 0;
+    g_bench_stats->questions_remarked = 0;
+    g_bench_stats->lock_acquires = 0;
+    g_bench_stats->lock_waits = 0;
+    g_bench_stats->num_samples = 0;
+    g_bench_stats->num_exam_samples = 0;
+    g_bench_stats->race = RaceCounts();
+    g_delay_scale = delay.scale;
+
+    double start = bench_now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);
+        if (chdir(corpus.c_str()) != 0) {
+            _exit(2);
+        }
+        std::ofstream rubric("rubric.txt");
+        rubric << DEFAULT_RUBRIC;
+        rubric.close();
+
+        // The engines narrate every step; keep that out of the CSV
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+
+        set_scheduler(policy);
+        _exit(engine.run(num_tas, input == "archive" ? ARCHIVE_FILE : nullptr));
+    } else if (pid < 0) {
+        perror("fork");
+        result.status = "failed";
+        return result;
+    }
+    setpgid(pid, pid);
+
+    int status = 0;
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    result.status = "ok";
+    while (wait4(pid, &status, WNOHANG, &usage) == 0) {
+        if (bench_now() - start > timeout_s) {
+            kill(-pid, SIGKILL);
+            wait4(pid, &status, 0, &usage);
+            shm_unlink("/ta_marking_shm");
+            shm_unlink(TA_STATS_SHM_NAME);
+            result.status = "timeout";
+            break;
+        }
+        usleep(1000);
+    }
+    result.wall_s = bench_now() - start;
+
+    if (result.status == "ok" && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) {
+        result.status = "failed";
+    }
+
+    result.questions = g_bench_stats->questions_marked;
+    result.remarks = g_bench_stats->questions_remarked;
+    result.throughput = result.wall_s > 0 ? result.questions / result.wall_s : 0.0;
+    result.lock_acquires = g_bench_stats->lock_acquires;
+    result.lock_waits = g_bench_stats->lock_waits;
+    result.max_rss_kb = usage.ru_maxrss;
+    result.race = g_bench_stats->race;
+
+    long n = std::min((long)g_bench_stats->num_samples, (long)BENCH_MAX_SAMPLES);
+    std::vector<double> samples(g_bench_stats->latency_ms, g_bench_stats->latency_ms + n);
+    result.p50_ms = percentile(samples, 0.50);
+    result.p99_ms = percentile(samples, 0.99);
+
+    n = std::min((long)g_bench_stats->num_exam_samples, (long)BENCH_MAX_SAMPLES);
+    std::vector<double> exam_samples(g_bench_stats->exam_ms, g_bench_stats->exam_ms + n);
+    result.exam_p50_ms = percentile(exam_samples, 0.50);
+    result.exam_p99_ms = percentile(exam_samples, 0.99);
+    return result;
+}
+
+std::string make_key(const std::string& engine, int tas, int exams, const std::string& delay,
+                     const std::string& input, const std::string& policy) {
+    return engine + "," + std::to_string(tas) + "," + std::to_string(exams) + "," + delay + "," +
+           input + "," + policy;
+}
+
+// Load engine,tas,exams,delay,input,policy -> throughput from an earlier CSV. Columns
+// are looked up by name so older CSVs with fewer columns still compare.
+std::map<std::string, double> load_baseline(const std::string& filename) {
+    std::map<std::string, double> baseline;
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open baseline " << filename << "\n";
+        exit(1);
+    }
+
+    std::string line;
+    std::getline(file, line);
+    std::map<std::string, size_t> column;
+    std::vector<std::string> header = split_list(line);
+    for (size_t i = 0; i < header.size(); i++) {
+        column[header[i]] = i;
+    }
+    for (const char* name : {"engine", "tas", "exams", "delay", "status", "throughput_qps"}) {
+        if (column.count(name) == 0) {
+            std::cerr << "Error: Baseline " << filename << " has no " << name << " column\n";
+            exit(1);
+        }
+    }
+
+    while (std::getline(file, line)) {
+        std::vector<std::string> cols = split_list(line);
+        if (cols.size() < header.size() || cols[column["status"]] != "ok") continue;
+        std::string input = column.count("input") ? cols[column["input"]] : "files";
+        std::string policy = column.count("policy") ? cols[column["policy"]] : DEFAULT_POLICY;
+        if (policy == "-") {
+            policy = DEFAULT_POLICY;
+        }
+        std::string key = make_key(cols[column["engine"]], atoi(cols[column["tas"]].c_str()),
+                                   atoi(cols[column["exams"]].c_str()), cols[column["delay"]],
+                                   input, policy);
+        baseline[key] = atof(cols[column["throughput_qps"]].c_str());
+    }
+    return baseline;
+}
+
+// Run one configuration, write its CSV row and check it against the baseline.
+// Returns false on a throughput regression.
+bool run_and_report(std::ostream& out, const BenchConfig& config,
+                    const std::map<std::string, double>& baseline, const std::string& name,
+                    int num_tas, int num_exams, const std::string& corpus,
+                    const std::string& input, const std::string& policy,
+                    const DelayModel& delay) {
+    std::cerr << "Running " << name << " tas=" << num_tas << " exams=" << num_exams
+              << " delay=" << delay.name << " input=" << input << " policy=" << policy << "\n";
+
+    BenchResult r = run_once(*find_engine(name), num_tas, corpus, input, policy, delay,
+                             config.timeout_s);
+    double contention = r.lock_acquires > 0 ? 100.0 * r.lock_waits / r.lock_acquires : 0.0;
+
+    out << name << "," << num_tas << "," << num_exams << "," << delay.name << ","
+        << r.status << "," << r.wall_s << "," << r.questions << ","
+        << (long)num_exams * NUM_QUESTIONS << "," << r.throughput << ","
+        << r.p50_ms << "," << r.p99_ms << "," << r.lock_acquires << ","
+        << r.lock_waits << "," << contention << "," << r.max_rss_kb << ","
+        << r.race.double_claims << "," << r.race.lost_completions << ","
+        << r.race.skipped_exams << "," << r.race.double_loaded_exams << ","
+        << r.race.slot_overwrites << "," << r.race.torn_rubric_writes << ","
+        << r.race.stale_rubric_writes << "," << input << "," << policy << ","
+        << r.exam_p50_ms << "," << r.exam_p99_ms << "," << r.remarks << "\n";
+    out.flush();
+
+    auto it = baseline.find(make_key(name, num_tas, num_exams, delay.name, input, policy));
+    if (it != baseline.end() && r.status == "ok" &&
+        r.throughput < it->second * (1.0 - config.tolerance)) {
+        std::cerr << "REGRESSION: " << it->first << " throughput " << r.throughput
+                  << " q/s vs baseline " << it->second << " q/s\n";
+        return false;
+    }
+    return true;
+}
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  --engines LIST     part_a,part_a_acct,part_b,part_b_adaptive,lockfree,\n"
+              << "                     lockfree_adaptive (default: all)\n"
+              << "  --tas LIST         TA counts (default: 2,4,8,16)\n"
+              << "  --exams LIST       corpus sizes (default: 25,1000)\n"
+              << "  --delays LIST      zero | original | scale:<f> (default: zero)\n"
+              << "  --inputs LIST      files | archive (default: files)\n"
+              << "  --policies LIST    scheduling policies: finish_first,spread,\n"
+              << "                     priority,affinity (default: finish_first)\n"
+              << "  --full             sweep TAs 2..256 and corpora 25..1000000\n"
+              << "  --timeout SEC      per-run time limit (default: 120)\n"
+              << "  --workdir DIR      where corpora are generated (default: /tmp/ta_bench)\n"
+              << "  --out FILE         write CSV to FILE instead of stdout\n"
+              << "  --baseline FILE    compare throughput against an earlier CSV\n"
+              << "  --tolerance FRAC   allowed throughput drop (default: 0.10)\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    config.engines = {"part_a", "part_a_acct", "part_b", "part_b_adaptive", "lockfree",
+                      "lockfree_adaptive"};
+    config.tas = {2, 4, 8, 16};
+    config.exams = {25, 1000};
+    config.workdir = "/tmp/ta_bench";
+    config.tolerance = 0.10;
+    config.timeout_s = 120.0;
+    config.inputs = {"files"};
+    config.policies = {DEFAULT_POLICY};
+    std::vector<std::string> delay_names = {"zero"};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--engines" && has_value) {
+            config.engines = split_list(argv[++i]);
+        } else if (arg == "--tas" && has_value) {
+            config.tas = parse_int_list(argv[++i]);
+        } else if (arg == "--exams" && has_value) {
+            config.exams = parse_int_list(argv[++i]);
+        } else if (arg == "--delays" && has_value) {
+            delay_names = split_list(argv[++i]);
+        } else if (arg == "--inputs" && has_value) {
+            config.inputs = split_list(argv[++i]);
+        } else if (arg == "--policies" && has_value) {
+            config.policies = split_list(argv[++i]);
+        } else if (arg == "--full") {
+            config.tas = {2, 4, 8, 16, 32, 64, 128, 256};
+            config.exams = {25, 100, 1000, 10000, 100000, 1000000};
+        } else if (arg == "--timeout" && has_value) {
+            config.timeout_s = atof(argv[++i]);
+        } else if (arg == "--workdir" && has_value) {
+            config.workdir = argv[++i];
+        } else if (arg == "--out" && has_value) {
+            config.out_file = argv[++i];
+        } else if (arg == "--baseline" && has_value) {
+            config.baseline_file = argv[++i];
+        } else if (arg == "--tolerance" && has_value) {
+            config.tolerance = atof(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    for (const auto& name : delay_names) {
+        DelayModel model;
+        if (!parse_delay_model(name, model)) {
+            std::cerr << "Error: Unknown delay model '" << name << "'\n";
+            return 1;
+        }
+        config.delays.push_back(model);
+    }
+    for (const auto& input : config.inputs) {
+        if (input != "files" && input != "archive") {
+            std::cerr << "Error: Unknown input '" << input << "'\n";
+            return 1;
+        }
+    }
+    for (const auto& policy : config.policies) {
+        if (!set_scheduler(policy)) {
+            std::cerr << "Error: Unknown policy '" << policy << "'\n";
+            return 1;
+        }
+    }
+    for (const auto& name : config.engines) {
+        if (find_engine(name) == nullptr) {
+            std::cerr << "Error: Unknown engine '" << name << "'\n";
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!config.baseline_file.empty()) {
+        baseline = load_baseline(config.baseline_file);
+    }
+
+    std::ofstream out_file;
+    if (!config.out_file.empty()) {
+        out_file.open(config.out_file);
+        if (!out_file.is_open()) {
+            std::cerr << "Error: Cannot write " << config.out_file << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = config.out_file.empty() ? std::cout : out_file;
+
+    g_bench_stats = (BenchStats*)mmap(NULL, sizeof(BenchStats), PROT_READ | PROT_WRITE,
+                                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (g_bench_stats == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    out << "engine,tas,exams,delay,status,wall_s,questions,expected_questions,"
+        << "throughput_qps,p50_ms,p99_ms,lock_acquires,lock_waits,contention_pct,max_rss_kb,"
+        << "double_claims,lost_completions,skipped_exams,double_loaded_exams,slot_overwrites,"
+        << "torn_rubric_writes,stale_rubric_writes,input,policy,exam_p50_ms,exam_p99_ms,remarks\n";
+    out.flush();
+
+    int regressions = 0;
+    for (int num_exams : config.exams) {
+        if (num_exams < 1 || num_exams >= MAX_EXAMS) {
+            std::cerr << "Skipping corpus of " << num_exams << " exams (MAX_EXAMS is "
+                      << MAX_EXAMS << ")\n";
+            continue;
+        }
+        std::string corpus = prepare_corpus(config.workdir, num_exams);
+        if (std::find(config.inputs.begin(), config.inputs.end(), "archive") != config.inputs.end() &&
+            !prepare_archive(corpus)) {
+            return 1;
+        }
+
+        for (const auto& input : config.inputs) {
+            for (const auto& delay : config.delays) {
+                for (int num_tas : config.tas) {
+                    for (const auto& name : config.engines) {
+                        for (const auto& policy : config.policies) {
+                            if (!run_and_report(out, config, baseline, name, num_tas, num_exams,
+                                                corpus, input, policy, delay)) {
+                                regressions++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    munmap(g_bench_stats, sizeof(BenchStats));
+
+    if (regressions > 0) {
+        std::cerr << regressions << " regression(s) against " << config.baseline_file << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file ta_marking_bench.h
+ * @brief Benchmark hooks compiled into the TA marking engines
+ * @author Student 1: Bhagya Patel (101324150)
+ * @author Student 2: Oluwatobi Olowookere (101245900)
+ *
+ * The hooks only do something when TA_MARKING_BENCH is defined (the
+ * ta_marking_bench driver does this). In the normal part_a / part_b builds
+ * they are empty inline functions and compile away.
+ */
+#ifndef TA_MARKING_BENCH_H
+#define TA_MARKING_BENCH_H
+
+// Race impact of one Part A run, as measured by RaceAccounted<NoSync>
+struct RaceCounts {
+    long double_claims;        // Questions claimed by more than one TA
+    long lost_completions;     // questions_completed++ that were overwritten
+    long skipped_exams;        // Exam files never loaded
+    long double_loaded_exams;  // Extra loads of an exam file that was already loaded
+    long slot_overwrites;      // Exams loaded into a slot another exam was using
+    long torn_rubric_writes;   // Rubric writes that overlapped another write
+    long stale_rubric_writes;  // Rubric writes based on an out-of-date read
+};
+
+#ifdef TA_MARKING_BENCH
+
+#include <atomic>
+#include <ctime>
+
+#define BENCH_MAX_SAMPLES (1 << 20)
+
+// Counters shared between the benchmark driver and every forked TA
+struct BenchStats {
+    std::atomic<long> questions_marked;    // Questions finished by any TA
+    std::atomic<long> questions_remarked;  // Re-marks after rubric corrections
+    std::atomic<long> lock_acquires;       // Locks taken by the engine (sem_wait() or atomics)
+    std::atomic<long> lock_waits;          // ... of which had to block
+    std::atomic<long> num_samples;         // Latency samples written so far
+    std::atomic<long> num_exam_samples;    // Exam completion samples written so far
+    RaceCounts race;                       // Filled in by part_a_acct runs
+    double latency_ms[BENCH_MAX_SAMPLES];  // Per-question latency (first N only)
+    double exam_ms[BENCH_MAX_SAMPLES];     // Exam load -> fully marked (first N only)
+};
+
+// Set up by the driver in an anonymous shared mapping before each run
+extern BenchStats* g_bench_stats;
+
+// Monotonic clock in seconds
+inline double bench_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Called once a TA has claimed a question
+inline double bench_question_begin() {
+    return bench_now();
+}
+
+// Called once the question is marked and counted as completed
+inline void bench_question_end(double start) {
+    if (g_bench_stats == nullptr) return;
+
+    g_bench_stats->questions_marked++;
+    long idx = g_bench_stats->num_samples++;
+    if (idx < BENCH_MAX_SAMPLES) {
+        g_bench_stats->latency_ms[idx] = (bench_now() - start) * 1000.0;
+    }
+}
+
+// Called when an exam's last question is marked, with its time since loading
+inline void bench_exam_end(double seconds) {
+    if (g_bench_stats == nullptr) return;
+
+    long idx = g_bench_stats->num_exam_samples++;
+    if (idx < BENCH_MAX_SAMPLES) {
+        g_bench_stats->exam_ms[idx] = seconds * 1000.0;
+    }
+}
+
+// Called when a TA finishes re-marking a question made stale by a correction
+inline void bench_question_remarked() {
+    if (g_bench_stats == nullptr) return;
+    g_bench_stats->questions_remarked++;
+}
+
+// Called by the lock-free engine when it takes a lock built from atomics
+// (semaphore locks are counted by the driver's sem_wait() replacement)
+inline void bench_lock_acquired(bool waited) {
+    if (g_bench_stats == nullptr) return;
+
+    g_bench_stats->lock_acquires++;
+    if (waited) {
+        g_bench_stats->lock_waits++;
+    }
+}
+
+// Called at the end of a run with race accounting
+inline void bench_race_counts(const RaceCounts& counts) {
+    if (g_bench_stats == nullptr) return;
+    g_bench_stats->race = counts;
+}
+
+#else
+
+inline double bench_question_begin() { return 0.0; }
+inline void bench_question_end(double) {}
+inline void bench_exam_end(double) {}
+inline void bench_question_remarked() {}
+inline void bench_lock_acquired(bool) {}
+inline void bench_race_counts(const RaceCounts&) {}
+
+#endif  // TA_MARKING_BENCH
+
+#endif  // TA_MARKING_BENCH_H
@@ -0,0 +1,130 @@
+/**
+ * @file ta_marking_common.h
+ * @brief Helpers shared by the shared memory engine and distributed marking
+ * @author Student 1: Bhagya Patel (101324150)
+ * @author Student 2: Oluwatobi Olowookere (101245900)
+ *
+ * ta_marking_engine.h and ta_marking_remote.cpp mark the same exams with the
+ * same rubric, so the clock, the simulated delays, the rubric file handling,
+ * the rubric correction and the exam file scan live here once.
+ */
+#ifndef TA_MARKING_COMMON_H
+#define TA_MARKING_COMMON_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <dirent.h>
+
+// Monotonic clock in seconds
+inline double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Get random delay
+inline double get_random_delay(double min_sec, double max_sec) {
+    static thread_local std::mt19937 gen(std::random_device{}() + getpid());
+    std::uniform_real_distribution<> dis(min_sec, max_sec);
+    return dis(gen);
+}
+
+// Split the rubric into its non-empty lines
+inline std::vector<std::string> parse_rubric(const std::string& rubric) {
+    std::istringstream iss(rubric);
+    std::string line;
+    std::vector<std::string> lines;
+    while (std::getline(iss, line)) {
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+// Rubric lines back into text, one per line
+inline std::string format_rubric(const std::vector<std::string>& lines) {
+    std::ostringstream rubric;
+    for (const auto& line : lines) {
+        rubric << line << "\n";
+    }
+    return rubric.str();
+}
+
+// Load rubric.txt as its non-empty lines
+inline bool load_rubric(std::vector<std::string>& lines) {
+    std::ifstream file("rubric.txt");
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open rubric.txt\n";
+        return false;
+    }
+
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    lines = parse_rubric(content);
+    return true;
+}
+
+// Save rubric to file
+inline void save_rubric(const std::vector<std::string>& lines) {
+    std::ofstream file("rubric.txt");
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot write rubric.txt\n";
+        return;
+    }
+    file << format_rubric(lines);
+}
+
+// Correct a rubric line: the answer is the character after the comma, and a
+// correction bumps it to the next one. False if the line has no answer.
+inline bool correct_rubric_line(std::string& line, char& old_answer, char& new_answer) {
+    size_t comma_pos = line.find(',');
+    if (comma_pos == std::string::npos || comma_pos + 2 >= line.length()) {
+        return false;
+    }
+
+    old_answer = line[comma_pos + 2];
+    new_answer = old_answer + 1;
+    line[comma_pos + 2] = new_answer;
+    return true;
+}
+
+// Scan the current directory for exam files, in sorted order
+inline std::vector<std::string> list_exam_files() {
+    std::vector<std::string> files;
+
+    DIR* dir = opendir(".");
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            std::string filename = entry->d_name;
+            if (filename.find("exam_") == 0 && filename.find(".txt") != std::string::npos) {
+                files.push_back(filename);
+            }
+        }
+        closedir(dir);
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// Student number on the first line of an exam file (-1 if it can't be read)
+inline int read_exam_student_number(const std::string& filename) {
+    std::ifstream file(filename);
+    std::string first_line;
+    if (!std::getline(file, first_line)) {
+        return -1;
+    }
+    return atoi(first_line.c_str());
+}
+
+#endif  // TA_MARKING_COMMON_H
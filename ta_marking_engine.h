@@ -0,0 +1,1687 @@
+/**
+ * @file ta_marking_engine.h
+ * @brief The TA marking engine shared by Part A, Part B and the benchmark
+ * @author Student 1: Bhagya Patel (101324150)
+ * @author Student 2: Oluwatobi Olowookere (101245900)
+ *
+ * The engine is written once, as MarkingEngine<Sync, NumQuestions>, and the
+ * synchronization policy decides how TAs share the rubric and the exams:
+ *
+ *   NoSync         no locking at all (Part 2a: races on purpose)
+ *   SemaphoreSync  process-shared semaphores: readers-writers lock on the
+ *                  rubric, a mutex per exam and one for loading (Part 2b)
+ *   AtomicSync     no blocking locks: questions are claimed with
+ *                  compare-and-swap, the rubric is a seqlock, and loading
+ *                  is a try-lock that other TAs skip instead of waiting on
+ *
+ * A policy's lock fields are empty base classes of the shared structures and
+ * its lock calls are static inline functions, so for NoSync both compile away
+ * entirely. Wrapping a policy in RaceAccounted<> adds shadow atomic counters
+ * that measure what the races cost (see RaceShadow).
+ *
+ * On top of that every variant gets the same features: exam files or a
+ * packed archive (exam_archive.h), scheduling policies (--policy), the
+ * adaptive TA pool (--adaptive), the ta_top stats page (ta_stats.h) and the
+ * benchmark hooks (ta_marking_bench.h).
+ */
+#ifndef TA_MARKING_ENGINE_H
+#define TA_MARKING_ENGINE_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <atomic>
+#include <type_traits>
+#include <unistd.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <numeric>
+#include <climits>
+
+#include "ta_marking_bench.h"
+#include "ta_marking_common.h"
+#include "exam_archive.h"
+#include "ta_stats.h"
+
+#define MAX_RUBRIC_SIZE 2048
+#ifndef MAX_EXAM_SIZE
+#define MAX_EXAM_SIZE 4096
+#endif
+#ifndef MAX_EXAMS
+#define MAX_EXAMS 100
+#endif
+#define NUM_QUESTIONS 5  // Question count the part_a / part_b programs are built with
+#define MAX_TAS 256
+
+// Adaptive TA pool tuning
+#define SUPERVISOR_INTERVAL_US 200000  // Time between backlog checks
+#define QUESTIONS_PER_TA 5             // Backlog one TA is expected to keep up with
+#define RETIRE_AFTER_CHECKS 5          // Consecutive low-demand checks before retiring a TA
+#define RESCAN_EVERY_CHECKS 10         // Checks between scans for newly arrived exam files
+
+// Exams the parallel scheduling policies keep open (loaded, with unclaimed questions)
+#define SCHEDULER_WINDOW 4
+
+// ---------------------------------------------------------------------------
+// Process-wide state and helpers (set up before forking, inherited by the TAs)
+// ---------------------------------------------------------------------------
+
+// Exam archive mapped by run_marking_system() before forking the TAs
+// (base is NULL when the exams are read from exam_*.txt files)
+static ExamArchive exam_archive;
+
+// Archive entry loaded at each position of the load order (see order_archive())
+static std::vector<int> archive_load_order;
+
+// Student number -> priority, loaded from priorities.txt before forking
+static std::map<int, int> student_priorities;
+
+// Live stats page for ta_top (NULL if it could not be created)
+static TaStatsPage* stats = nullptr;
+
+// Publish what a TA is doing on the stats page
+inline void set_ta_state(int ta_id, TaState state, int student_num = 0, int question = 0) {
+    if (stats == nullptr) return;
+
+    TaStatsSlot& slot = stats->tas[ta_id];
+    slot.student_number.store(student_num, std::memory_order_relaxed);
+    slot.question.store(question, std::memory_order_relaxed);
+    slot.state.store(state, std::memory_order_relaxed);
+    slot.state_since_us.store(stats_now_us(), std::memory_order_relaxed);
+}
+
+// A TA found a lock taken and is about to wait for it
+inline void note_lock_wait(int ta_id, StatsLock lock) {
+    if (stats == nullptr) return;
+    stats->tas[ta_id].lock_waits.fetch_add(1, std::memory_order_relaxed);
+    stats->tas[ta_id].blocked_on.store(lock, std::memory_order_relaxed);
+}
+
+// A TA got a lock (after waiting for it if note_lock_wait() was called)
+inline void note_lock_acquired(int ta_id) {
+    if (stats == nullptr) return;
+    stats->tas[ta_id].blocked_on.store(STATS_LOCK_NONE, std::memory_order_relaxed);
+    stats->tas[ta_id].lock_acquires.fetch_add(1, std::memory_order_relaxed);
+}
+
+// sem_wait() that also counts the acquire, and whether it had to block, on
+// the stats page. While blocked, the TA's slot shows which lock it wants.
+inline void lock_sem(sem_t* sem, int ta_id, StatsLock lock) {
+    if (sem_trywait(sem) != 0) {
+        note_lock_wait(ta_id, lock);
+        sem_wait(sem);
+    }
+    note_lock_acquired(ta_id);
+}
+
+// Copy rubric lines into the shared memory rubric
+inline void copy_rubric(char* rubric, const std::vector<std::string>& lines) {
+    strncpy(rubric, format_rubric(lines).c_str(), MAX_RUBRIC_SIZE - 1);
+    rubric[MAX_RUBRIC_SIZE - 1] = '\0';
+}
+
+// Load optional per-student priorities ("<student_number> <priority>" per line)
+inline void load_priorities() {
+    std::ifstream file("priorities.txt");
+    if (!file.is_open()) {
+        return;
+    }
+
+    int student_num, priority;
+    while (file >> student_num >> priority) {
+        student_priorities[student_num] = priority;
+    }
+    std::cout << "Loaded " << student_priorities.size() << " student priorities\n";
+}
+
+// A student's priority from priorities.txt (0 if not listed)
+inline int student_priority(int student_num) {
+    auto priority = student_priorities.find(student_num);
+    return priority != student_priorities.end() ? priority->second : 0;
+}
+
+
+// ---------------------------------------------------------------------------
+// Scheduling policies: which exam a TA marks next and which question it takes
+// ---------------------------------------------------------------------------
+
+enum SchedulerKind {
+    SCHEDULER_FINISH_FIRST,
+    SCHEDULER_SPREAD,
+    SCHEDULER_PRIORITY,
+    SCHEDULER_AFFINITY,
+};
+
+struct SchedulerPolicy {
+    SchedulerKind kind;
+    const char* name;
+    const char* description;
+    int open_exams;  // Exams to keep open at once (0 = load only when out of work)
+};
+
+static const SchedulerPolicy SCHEDULERS[] = {
+    {SCHEDULER_FINISH_FIRST, "finish_first",
+     "finish the oldest exam before starting the next (default)", 0},
+    {SCHEDULER_SPREAD, "spread",
+     "spread TAs across several open exams", SCHEDULER_WINDOW},
+    {SCHEDULER_PRIORITY, "priority",
+     "highest priority student first (priorities.txt)", SCHEDULER_WINDOW},
+    {SCHEDULER_AFFINITY, "affinity",
+     "each TA keeps marking the same question number", SCHEDULER_WINDOW},
+};
+
+static const SchedulerPolicy* scheduler = &SCHEDULERS[0];
+
+// Select a scheduling policy by name
+inline bool set_scheduler(const std::string& name) {
+    for (const auto& policy : SCHEDULERS) {
+        if (name == policy.name) {
+            scheduler = &policy;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Synchronization policies
+// ---------------------------------------------------------------------------
+
+// No synchronization (Part 2a). Every call is empty and the lock "fields"
+// are empty base classes, so this variant has no locking code or data at all.
+struct NoSync {
+    static const bool race_accounting = false;
+    static const bool reparse_on_write = false;  // Writes from the lines read during review
+    static const bool recheck_on_load = false;   // Loads without looking for work again
+    static const char* name() { return "none"; }
+
+    typedef bool Flag;
+    typedef int Counter;
+
+    struct ExamLock {};
+    struct SharedLocks {};
+
+    static void init(SharedLocks&) {}
+    static void destroy(SharedLocks&) {}
+    static void init_exam(ExamLock&) {}
+    static void destroy_exam(ExamLock&) {}
+
+    static void lock_exam(ExamLock&, int) {}
+    static void unlock_exam(ExamLock&) {}
+
+    // Claim a question a scheduler found unclaimed (RACE CONDITION: two TAs
+    // can both see it unclaimed)
+    static bool claim(Flag& flag) {
+        if (flag) return false;
+        flag = true;
+        return true;
+    }
+
+    // Move a mark's rubric version tag from seen to now (claims a re-mark)
+    static bool retag(Counter& tag, int seen, int now) {
+        if (tag != seen) return false;
+        tag = now;
+        return true;
+    }
+
+    static unsigned begin_read(SharedLocks&, int) { return 0; }
+    static bool read_valid(SharedLocks&, unsigned) { return true; }
+    static void end_read(SharedLocks&, int) {}
+    static void begin_write(SharedLocks&, int) {}
+    static void end_write(SharedLocks&) {}
+
+    static bool begin_load(SharedLocks&, int, bool) { return true; }
+    static void end_load(SharedLocks&) {}
+};
+
+// Process-shared semaphores (Part 2b)
+struct SemaphoreSync {
+    static const bool race_accounting = false;
+    static const bool reparse_on_write = true;
+    static const bool recheck_on_load = true;
+    static const char* name() { return "semaphores"; }
+
+    typedef bool Flag;
+    typedef int Counter;
+
+    struct ExamLock {
+        sem_t exam_mutex;          // Mutex for this specific exam
+    };
+
+    struct SharedLocks {
+        sem_t rubric_mutex;        // For rubric writes (readers-writer)
+        sem_t reader_count_mutex;  // Protects reader_count
+        int reader_count;          // Number of active readers
+        sem_t exam_load_mutex;     // For loading new exams
+    };
+
+    static void init(SharedLocks& locks) {
+        sem_init(&locks.rubric_mutex, 1, 1);
+        sem_init(&locks.reader_count_mutex, 1, 1);
+        sem_init(&locks.exam_load_mutex, 1, 1);
+        locks.reader_count = 0;
+    }
+
+    static void destroy(SharedLocks& locks) {
+        sem_destroy(&locks.rubric_mutex);
+        sem_destroy(&locks.reader_count_mutex);
+        sem_destroy(&locks.exam_load_mutex);
+    }
+
+    static void init_exam(ExamLock& lock) { sem_init(&lock.exam_mutex, 1, 1); }
+    static void destroy_exam(ExamLock& lock) { sem_destroy(&lock.exam_mutex); }
+
+    static void lock_exam(ExamLock& lock, int ta_id) {
+        lock_sem(&lock.exam_mutex, ta_id, STATS_LOCK_EXAM);
+    }
+    static void unlock_exam(ExamLock& lock) { sem_post(&lock.exam_mutex); }
+
+    // Called with the exam mutex held
+    static bool claim(Flag& flag) {
+        if (flag) return false;
+        flag = true;
+        return true;
+    }
+
+    static bool retag(Counter& tag, int seen, int now) {
+        if (tag != seen) return false;
+        tag = now;
+        return true;
+    }
+
+    // READERS-WRITERS PATTERN: the first reader locks out writers, the last
+    // one lets them back in. The read lock is held for the whole review.
+    static unsigned begin_read(SharedLocks& locks, int ta_id) {
+        lock_sem(&locks.reader_count_mutex, ta_id, STATS_LOCK_READER_COUNT);
+        locks.reader_count++;
+        if (locks.reader_count == 1) {
+            lock_sem(&locks.rubric_mutex, ta_id, STATS_LOCK_RUBRIC);
+        }
+        sem_post(&locks.reader_count_mutex);
+        return 0;
+    }
+
+    static bool read_valid(SharedLocks&, unsigned) { return true; }
+
+    static void end_read(SharedLocks& locks, int ta_id) {
+        lock_sem(&locks.reader_count_mutex, ta_id, STATS_LOCK_READER_COUNT);
+        locks.reader_count--;
+        if (locks.reader_count == 0) {
+            sem_post(&locks.rubric_mutex);
+        }
+        sem_post(&locks.reader_count_mutex);
+    }
+
+    static void begin_write(SharedLocks& locks, int ta_id) {
+        lock_sem(&locks.rubric_mutex, ta_id, STATS_LOCK_RUBRIC);
+    }
+    static void end_write(SharedLocks& locks) { sem_post(&locks.rubric_mutex); }
+
+    // Loading always waits for the loader lock
+    static bool begin_load(SharedLocks& locks, int ta_id, bool) {
+        lock_sem(&locks.exam_load_mutex, ta_id, STATS_LOCK_EXAM_LOAD);
+        return true;
+    }
+    static void end_load(SharedLocks& locks) { sem_post(&locks.exam_load_mutex); }
+};
+
+// Lock-free marking: TAs never sleep on a lock.
+//  - Questions are claimed with compare-and-swap on their flag, so there is
+//    no per-exam mutex.
+//  - The rubric is a seqlock: readers copy it and retry if a write happened
+//    meanwhile, and only writers exclude each other (spinning, briefly).
+//  - Loading is a try-lock: while one TA loads, the others go back to marking.
+struct AtomicSync {
+    static const bool race_accounting = false;
+    static const bool reparse_on_write = true;
+    static const bool recheck_on_load = true;
+    static const char* name() { return "atomics"; }
+
+    typedef std::atomic<bool> Flag;
+    typedef std::atomic<int> Counter;
+
+    struct ExamLock {};
+
+    struct SharedLocks {
+        std::atomic<unsigned> rubric_seq;  // Odd while a rubric write is in progress
+        std::atomic<bool> loading;         // A TA is loading an exam
+    };
+
+    static void init(SharedLocks& locks) {
+        locks.rubric_seq.store(0);
+        locks.loading.store(false);
+    }
+    static void destroy(SharedLocks&) {}
+    static void init_exam(ExamLock&) {}
+    static void destroy_exam(ExamLock&) {}
+
+    static void lock_exam(ExamLock&, int) {}
+    static void unlock_exam(ExamLock&) {}
+
+    static bool claim(Flag& flag) {
+        bool expected = false;
+        return flag.compare_exchange_strong(expected, true);
+    }
+
+    static bool retag(Counter& tag, int seen, int now) {
+        return tag.compare_exchange_strong(seen, now);
+    }
+
+    static unsigned begin_read(SharedLocks& locks, int) {
+        unsigned seq;
+        while ((seq = locks.rubric_seq.load(std::memory_order_acquire)) & 1) {
+            sched_yield();
+        }
+        return seq;
+    }
+
+    // The copy made since begin_read() is only good if no write started
+    static bool read_valid(SharedLocks& locks, unsigned seq) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return locks.rubric_seq.load(std::memory_order_relaxed) == seq;
+    }
+
+    static void end_read(SharedLocks&, int) {}
+
+    static void begin_write(SharedLocks& locks, int ta_id) {
+        bool waited = false;
+        unsigned seq = locks.rubric_seq.load(std::memory_order_relaxed);
+        while ((seq & 1) ||
+               !locks.rubric_seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire)) {
+            if (!waited) {
+                note_lock_wait(ta_id, STATS_LOCK_RUBRIC);
+                waited = true;
+            }
+            sched_yield();
+            seq = locks.rubric_seq.load(std::memory_order_relaxed);
+        }
+        note_lock_acquired(ta_id);
+        bench_lock_acquired(waited);
+    }
+
+    static void end_write(SharedLocks& locks) {
+        locks.rubric_seq.fetch_add(1, std::memory_order_release);
+    }
+
+    // With may_skip a TA that finds another one loading gives up right away
+    static bool begin_load(SharedLocks& locks, int ta_id, bool may_skip) {
+        bool expected = false;
+        if (!locks.loading.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            if (may_skip) return false;
+
+            note_lock_wait(ta_id, STATS_LOCK_EXAM_LOAD);
+            do {
+                sched_yield();
+                expected = false;
+            } while (!locks.loading.compare_exchange_weak(expected, true,
+                                                          std::memory_order_acquire));
+            note_lock_acquired(ta_id);
+            bench_lock_acquired(true);
+            return true;
+        }
+        note_lock_acquired(ta_id);
+        bench_lock_acquired(false);
+        return true;
+    }
+
+    static void end_load(SharedLocks& locks) {
+        locks.loading.store(false, std::memory_order_release);
+    }
+};
+
+// Any policy, plus shadow counters that measure the cost of its races
+template <class Base>
+struct RaceAccounted : Base {
+    static const bool race_accounting = true;
+};
+
+// ---------------------------------------------------------------------------
+// Race accounting
+// ---------------------------------------------------------------------------
+
+// Without accounting every hook is empty and the base class takes no space
+struct NoRaceShadow {
+    void exam_stored(int) {}
+    void exam_file_loaded(int) {}
+    void question_claimed(int, int) {}
+    void question_completed(int) {}
+    int rubric_read() { return 0; }
+    void rubric_write_begin(int) {}
+    void rubric_write_end() {}
+
+    template <class Shared>
+    RaceCounts impact(const Shared*) const { return RaceCounts(); }
+};
+
+// Shadow counters for the racy fields. Updated atomically, so they hold the
+// values the unsynchronized code would have computed without the races.
+template <int NumQuestions>
+struct RaceShadow {
+    std::atomic<int> question_claims[MAX_EXAMS][NumQuestions];  // Claims per question
+    std::atomic<int> questions_completed[MAX_EXAMS];            // True completion count
+    std::atomic<int> file_loads[MAX_EXAMS];                     // Loads per exam file
+    std::atomic<int> slot_loads[MAX_EXAMS];                     // Loads per exam slot
+    std::atomic<int> rubric_writers;                            // Writers inside the update
+    std::atomic<int> rubric_version;                            // Completed rubric writes
+    std::atomic<long> double_claims;
+    std::atomic<long> slot_overwrites;
+    std::atomic<long> torn_rubric_writes;
+    std::atomic<long> stale_rubric_writes;
+
+    void exam_stored(int exam_slot) {
+        if (slot_loads[exam_slot]++ > 0) {
+            slot_overwrites++;
+        }
+        questions_completed[exam_slot] = 0;
+        for (int i = 0; i < NumQuestions; i++) {
+            question_claims[exam_slot][i] = 0;
+        }
+    }
+
+    void exam_file_loaded(int exam_idx) { file_loads[exam_idx]++; }
+
+    void question_claimed(int exam_slot, int question) {
+        if (question_claims[exam_slot][question]++ > 0) {
+            double_claims++;
+        }
+    }
+
+    void question_completed(int exam_slot) { questions_completed[exam_slot]++; }
+
+    int rubric_read() { return rubric_version; }
+
+    void rubric_write_begin(int rubric_version_read) {
+        if (rubric_writers++ > 0) {
+            torn_rubric_writes++;
+        }
+        if (rubric_version != rubric_version_read) {
+            stale_rubric_writes++;
+        }
+    }
+
+    void rubric_write_end() {
+        rubric_version++;
+        rubric_writers--;
+    }
+
+    // Compare the shadow counters with what the racy code ended up with
+    template <class Shared>
+    RaceCounts impact(const Shared* shared) const {
+        RaceCounts counts = {};
+        counts.double_claims = double_claims;
+        counts.slot_overwrites = slot_overwrites;
+        counts.torn_rubric_writes = torn_rubric_writes;
+        counts.stale_rubric_writes = stale_rubric_writes;
+
+        for (int i = 0; i < MAX_EXAMS; i++) {
+            if (slot_loads[i] == 0) continue;
+            int lost = questions_completed[i] - shared->exams[i].questions_completed;
+            if (lost > 0) {
+                counts.lost_completions += lost;
+            }
+        }
+
+        // Only files up to the last one loaded were expected to be loaded
+        int last_loaded = -1;
+        for (int i = 0; i < shared->num_exam_files; i++) {
+            if (file_loads[i] > 0) {
+                last_loaded = i;
+            }
+        }
+        for (int i = 0; i <= last_loaded; i++) {
+            int loads = file_loads[i];
+            if (loads == 0) {
+                counts.skipped_exams++;
+            } else {
+                counts.double_loaded_exams += loads - 1;
+            }
+        }
+
+        return counts;
+    }
+};
+
+// Print the race impact summary
+inline void print_race_impact(const RaceCounts& counts) {
+    std::cout << "\n=== Race impact ===\n";
+    std::cout << "Double-claimed questions:  " << counts.double_claims << "\n";
+    std::cout << "Lost completion updates:   " << counts.lost_completions << "\n";
+    std::cout << "Skipped exams:             " << counts.skipped_exams << "\n";
+    std::cout << "Double-loaded exams:       " << counts.double_loaded_exams << "\n";
+    std::cout << "Overwritten exam slots:    " << counts.slot_overwrites << "\n";
+    std::cout << "Torn rubric writes:        " << counts.torn_rubric_writes << "\n";
+    std::cout << "Stale rubric writes:       " << counts.stale_rubric_writes << "\n";
+}
+
+// TA pool bookkeeping, kept by the parent process only
+struct TaPool {
+    int min_tas;
+    int max_tas;
+    pid_t pids[MAX_TAS + 1];  // pids[id] is TA <id>'s process, 0 if the id is free
+    int running;              // TA processes not yet reaped
+    int active;               // ... of which have not been asked to retire
+};
+
+// ---------------------------------------------------------------------------
+// The engine
+// ---------------------------------------------------------------------------
+
+template <class Sync, int NumQuestions>
+struct MarkingEngine {
+    typedef typename Sync::Flag Flag;
+    typedef typename Sync::Counter Counter;
+    typedef typename std::conditional<Sync::race_accounting, RaceShadow<NumQuestions>,
+                                      NoRaceShadow>::type Race;
+
+    // Structure for exam in shared memory
+    struct ExamData : Sync::ExamLock {
+        char exam_content[MAX_EXAM_SIZE];
+        int student_number;
+        bool sentinel;                        // Termination exam: ends the run, never marked
+        Flag questions_marked[NumQuestions];  // Claimed by a TA
+        Counter questions_completed;          // How many questions done
+        Counter marked_version[NumQuestions]; // Rubric entry version each question was marked under
+        int priority;                         // Scheduling priority from priorities.txt
+        double load_time;                     // When the exam was loaded (monotonic seconds)
+        double done_time;                     // When its last question was marked (0 until then)
+    };
+
+    // Shared memory structure
+    struct SharedData : Sync::SharedLocks, Race {
+        char rubric[MAX_RUBRIC_SIZE];
+        ExamData exams[MAX_EXAMS];
+        Counter total_exams_loaded;
+        Flag all_done;
+        char exam_filenames[MAX_EXAMS][256];
+        Counter num_exam_files;
+        Counter next_exam_to_load;
+        int rubric_version;        // Rubric corrections so far (changed inside a rubric write)
+
+        // Re-marking after rubric corrections
+        Counter rubric_entry_version[NumQuestions];  // Corrections to each rubric line
+        Counter remark_from[NumQuestions];  // Question k is current below this slot (scan hint)
+        Counter questions_remarked;
+
+        // Scheduling
+        Flag sentinel_loaded;      // Termination exam loaded; stop once the rest are claimed
+        Counter scan_start;        // Every question below this slot is claimed (scan hint)
+        double start_time;         // When marking started (monotonic seconds)
+
+        // Adaptive TA pool
+        Flag ta_retire[MAX_TAS + 1];  // Set by the supervisor to retire TA <id>
+
+        Race& race() { return *this; }
+    };
+
+    // Copy an exam's text into a shared memory slot and reset its marking state
+    static void store_exam(SharedData* shared, int exam_slot, const char* content, size_t length,
+                           int student_num, bool sentinel) {
+        ExamData& exam = shared->exams[exam_slot];
+        size_t copy_len = std::min(length, (size_t)MAX_EXAM_SIZE - 1);
+        memcpy(exam.exam_content, content, copy_len);
+        exam.exam_content[copy_len] = '\0';
+        exam.student_number = student_num;
+        exam.sentinel = sentinel;
+        exam.questions_completed = 0;
+
+        for (int i = 0; i < NumQuestions; i++) {
+            exam.questions_marked[i] = false;
+            exam.marked_version[i] = 0;
+        }
+
+        Sync::init_exam(exam);
+
+        exam.priority = student_priority(student_num);
+        exam.load_time = now_seconds();
+        exam.done_time = 0;
+
+        shared->race().exam_stored(exam_slot);
+    }
+
+    // Load an exam file into shared memory
+    static bool load_exam_into_memory(SharedData* shared, const std::string& filename,
+                                      int exam_slot) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        // Read entire file
+        std::string content((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+        file.close();
+
+        // Parse student number (first line)
+        size_t first_newline = content.find('\n');
+        if (first_newline == std::string::npos) return false;
+
+        int student_num = std::stoi(content.substr(0, first_newline));
+
+        // Files have no flags; student 9999 is the termination exam
+        store_exam(shared, exam_slot, content.c_str(), content.size(), student_num,
+                   student_num == 9999);
+        return true;
+    }
+
+    // Load an exam out of the mapped archive (no file system access)
+    static bool load_exam_from_archive(SharedData* shared, int exam_idx, int exam_slot) {
+        const ExamArchiveEntry& entry = exam_archive.entries[archive_load_order[exam_idx]];
+        store_exam(shared, exam_slot, exam_archive.base + entry.offset, entry.length,
+                   entry.student_number, entry.flags & EXAM_FLAG_SENTINEL);
+        return true;
+    }
+
+    // Load the exam_idx'th exam, from the archive or from its file
+    static bool load_exam(SharedData* shared, int exam_idx, int exam_slot) {
+        if (exam_archive.base != nullptr) {
+            return load_exam_from_archive(shared, exam_idx, exam_slot);
+        }
+        return load_exam_into_memory(shared, shared->exam_filenames[exam_idx], exam_slot);
+    }
+
+    // Describe the exam_idx'th exam for log messages
+    static std::string exam_source_name(SharedData* shared, int exam_idx) {
+        if (exam_archive.base != nullptr) {
+            return "archive entry " + std::to_string(archive_load_order[exam_idx]);
+        }
+        return shared->exam_filenames[exam_idx];
+    }
+
+    // Review rubric and potentially correct it
+    static void review_and_correct_rubric(SharedData* shared, int ta_id) {
+        std::cout << "[TA " << ta_id << "] Requesting read access to rubric\n";
+        set_ta_state(ta_id, TA_STATE_READING_RUBRIC);
+
+        // Reading phase. Only AtomicSync can see a read overlap a write, and
+        // then it simply reads the rubric again.
+        std::vector<std::string> lines;
+        int rubric_version_read;
+        unsigned read_token;
+        do {
+            read_token = Sync::begin_read(*shared, ta_id);
+            rubric_version_read = shared->race().rubric_read();
+            lines = parse_rubric(shared->rubric);
+        } while (!Sync::read_valid(*shared, read_token));
+
+        bool needs_correction = false;
+        int line_to_correct = -1;
+
+        // Iterate through each question in rubric
+        for (size_t i = 0; i < lines.size() && i < (size_t)NumQuestions; i++) {
+            // Decision time: 0.5-1.0 seconds
+            std::cout << "[TA " << ta_id << "] Reviewing rubric question " << (i+1) << "...\n";
+            usleep(get_random_delay(0.5, 1.0) * 1000000);
+
+            // Randomly decide if correction needed
+            if (rand() % 100 < 30) {  // 30% chance
+                std::cout << "[TA " << ta_id << "] Detected error in rubric question " << (i+1) << "\n";
+                needs_correction = true;
+                line_to_correct = i;
+                break;  // Only correct one per review
+            }
+        }
+
+        Sync::end_read(*shared, ta_id);
+        std::cout << "[TA " << ta_id << "] Finished reading rubric\n";
+
+        if (!needs_correction || line_to_correct < 0) {
+            return;
+        }
+
+        // Writing phase
+        std::cout << "[TA " << ta_id << "] Requesting WRITE access to rubric\n";
+        set_ta_state(ta_id, TA_STATE_CORRECTING_RUBRIC);
+        Sync::begin_write(*shared, ta_id);
+
+        // The finish check runs under the write lock too. Once it has passed
+        // there is nobody left to re-mark, so the correction is dropped; any
+        // earlier correction is re-marked like the rest.
+        if (shared->all_done) {
+            Sync::end_write(*shared);
+            std::cout << "[TA " << ta_id << "] Marking has finished, dropped rubric correction\n";
+            return;
+        }
+
+        // Re-parse in case it changed. Without a write lock that would only
+        // narrow the race, so NoSync writes from its (possibly stale) review read.
+        if (Sync::reparse_on_write) {
+            rubric_version_read = shared->race().rubric_read();
+            lines = parse_rubric(shared->rubric);
+        }
+
+        if (line_to_correct < (int)lines.size()) {
+            char old_char, new_char;
+            if (correct_rubric_line(lines[line_to_correct], old_char, new_char)) {
+                std::cout << "[TA " << ta_id << "] Changed '" << old_char << "' to '"
+                          << new_char << "' in question " << (line_to_correct + 1) << "\n";
+            }
+
+            // Update shared memory (RACE CONDITION under NoSync)
+            shared->race().rubric_write_begin(rubric_version_read);
+            copy_rubric(shared->rubric, lines);
+            shared->rubric_version++;
+            shared->race().rubric_write_end();
+            if (stats != nullptr) {
+                stats->rubric_version.store(shared->rubric_version, std::memory_order_relaxed);
+            }
+
+            // Marks of this question made under the old line are now stale.
+            // Nothing is queued here: idle TAs find them by rescanning from slot 0.
+            int entry_version = ++shared->rubric_entry_version[line_to_correct];
+            shared->remark_from[line_to_correct] = 0;
+            std::cout << "[TA " << ta_id << "] Question " << (line_to_correct + 1)
+                      << " marks before rubric entry version " << entry_version
+                      << " need re-marking\n";
+
+            // Save to file
+            save_rubric(lines);
+            std::cout << "[TA " << ta_id << "] Saved corrected rubric to file\n";
+        }
+
+        Sync::end_write(*shared);
+        std::cout << "[TA " << ta_id << "] Released write lock\n";
+    }
+
+    // Count the questions of an exam that no TA has claimed yet
+    static int unclaimed_questions(const ExamData& exam) {
+        int unclaimed = 0;
+        for (int i = 0; i < NumQuestions; i++) {
+            if (!exam.questions_marked[i]) {
+                unclaimed++;
+            }
+        }
+        return unclaimed;
+    }
+
+    // An open exam still has a question for a TA to claim
+    static bool is_open_exam(const ExamData& exam) {
+        return !exam.sentinel && unclaimed_questions(exam) > 0;
+    }
+
+    // First slot worth scanning: moves the scan hint past exams whose questions
+    // are all claimed. Claims are never undone, so a stale hint only costs a
+    // longer scan.
+    static int first_slot_to_scan(SharedData* shared) {
+        int i = shared->scan_start;
+        while (i < shared->total_exams_loaded && !is_open_exam(shared->exams[i])) {
+            i++;
+        }
+        shared->scan_start = i;
+        return i;
+    }
+
+    static int count_open_exams(SharedData* shared) {
+        int open = 0;
+        for (int i = first_slot_to_scan(shared); i < shared->total_exams_loaded; i++) {
+            if (is_open_exam(shared->exams[i])) {
+                open++;
+            }
+        }
+        return open;
+    }
+
+    static bool has_open_exams(SharedData* shared) {
+        return first_slot_to_scan(shared) < shared->total_exams_loaded;
+    }
+
+    // finish_first: every TA works on the oldest exam that still has work
+    static int pick_finish_first(SharedData* shared, int) {
+        int i = first_slot_to_scan(shared);
+        return i < shared->total_exams_loaded ? i : -1;
+    }
+
+    // spread: the open exam with the fewest questions in progress, so TAs fan out
+    static int pick_spread(SharedData* shared, int) {
+        int best = -1;
+        int best_in_progress = NumQuestions + 1;
+        for (int i = first_slot_to_scan(shared); i < shared->total_exams_loaded; i++) {
+            const ExamData& exam = shared->exams[i];
+            if (!is_open_exam(exam)) continue;
+
+            int in_progress = NumQuestions - unclaimed_questions(exam) - exam.questions_completed;
+            if (in_progress < best_in_progress) {
+                best = i;
+                best_in_progress = in_progress;
+            }
+        }
+        return best;
+    }
+
+    // priority: the open exam of the highest priority student
+    static int pick_priority(SharedData* shared, int) {
+        int best = -1;
+        for (int i = first_slot_to_scan(shared); i < shared->total_exams_loaded; i++) {
+            if (!is_open_exam(shared->exams[i])) continue;
+
+            if (best == -1 || shared->exams[i].priority > shared->exams[best].priority) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // affinity: TA n keeps to question ((n - 1) % NumQuestions) across exams,
+    // so it keeps applying the same rubric line
+    static int affinity_question(int ta_id) {
+        return (ta_id - 1) % NumQuestions;
+    }
+
+    static int pick_affinity(SharedData* shared, int ta_id) {
+        int question = affinity_question(ta_id);
+        int fallback = -1;
+        for (int i = first_slot_to_scan(shared); i < shared->total_exams_loaded; i++) {
+            if (!is_open_exam(shared->exams[i])) continue;
+
+            if (!shared->exams[i].questions_marked[question]) {
+                return i;
+            }
+            if (fallback == -1) {
+                fallback = i;
+            }
+        }
+        return fallback;
+    }
+
+    // First question nobody has claimed yet
+    static int pick_question_first(const ExamData& exam) {
+        for (int i = 0; i < NumQuestions; i++) {
+            if (!exam.questions_marked[i]) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // The TA's own question number if it is free, otherwise the first free one
+    static int pick_question_affinity(const ExamData& exam, int ta_id) {
+        int question = affinity_question(ta_id);
+        if (!exam.questions_marked[question]) {
+            return question;
+        }
+        return pick_question_first(exam);
+    }
+
+    // Find an exam with unclaimed questions (-1 if there is none)
+    static int find_exam_to_mark(SharedData* shared, int ta_id) {
+        switch (scheduler->kind) {
+            case SCHEDULER_SPREAD:   return pick_spread(shared, ta_id);
+            case SCHEDULER_PRIORITY: return pick_priority(shared, ta_id);
+            case SCHEDULER_AFFINITY: return pick_affinity(shared, ta_id);
+            default:                 return pick_finish_first(shared, ta_id);
+        }
+    }
+
+    static int pick_question(const ExamData& exam, int ta_id) {
+        if (scheduler->kind == SCHEDULER_AFFINITY) {
+            return pick_question_affinity(exam, ta_id);
+        }
+        return pick_question_first(exam);
+    }
+
+    // Should another exam be loaded even though there may be work available?
+    static bool wants_more_open_exams(SharedData* shared) {
+        return scheduler->open_exams > 0 && !shared->sentinel_loaded &&
+               shared->next_exam_to_load < shared->num_exam_files &&
+               count_open_exams(shared) < scheduler->open_exams;
+    }
+
+    // Mark one question on an exam
+    static bool mark_one_question(SharedData* shared, int ta_id, int exam_idx) {
+        ExamData& exam = shared->exams[exam_idx];
+
+        // Claim an unmarked question. A failed claim means another TA took
+        // that question first, so pick again.
+        Sync::lock_exam(exam, ta_id);
+        int question_to_mark;
+        while ((question_to_mark = pick_question(exam, ta_id)) != -1 &&
+               !Sync::claim(exam.questions_marked[question_to_mark])) {
+        }
+        if (question_to_mark != -1) {
+            // Tag the mark with the rubric line it is made under. A re-marking TA
+            // that sees the claim before the tag only re-marks it needlessly.
+            exam.marked_version[question_to_mark] =
+                (int)shared->rubric_entry_version[question_to_mark];
+        }
+        int student_num = exam.student_number;
+        Sync::unlock_exam(exam);
+
+        if (question_to_mark == -1) {
+            return false;  // All questions already claimed
+        }
+        shared->race().question_claimed(exam_idx, question_to_mark);
+
+        double question_start = bench_question_begin();
+        set_ta_state(ta_id, TA_STATE_MARKING, student_num, question_to_mark + 1);
+
+        std::cout << "[TA " << ta_id << "] Marking question " << (question_to_mark + 1)
+                  << " for student " << student_num << "\n";
+
+        // Marking time: 1.0-2.0 seconds (NO LOCK HELD)
+        usleep(get_random_delay(1.0, 2.0) * 1000000);
+
+        std::cout << "[TA " << ta_id << "] Finished marking question " << (question_to_mark + 1)
+                  << " for student " << student_num << "\n";
+
+        // Update completion count (RACE CONDITION under NoSync)
+        Sync::lock_exam(exam, ta_id);
+        bool exam_done = ++exam.questions_completed == NumQuestions;
+        if (exam_done) {
+            exam.done_time = now_seconds();
+        }
+        Sync::unlock_exam(exam);
+        shared->race().question_completed(exam_idx);
+
+        bench_question_end(question_start);
+        // (A slot the racy NoSync loader counted but never filled has no load time)
+        if (exam_done && exam.load_time > 0) {
+            bench_exam_end(exam.done_time - exam.load_time);
+        }
+
+        if (stats != nullptr) {
+            stats->tas[ta_id].questions_marked.fetch_add(1, std::memory_order_relaxed);
+            if (exam_done) {
+                stats->tas[ta_id].exams_completed.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        return true;
+    }
+
+    // A question marked under an older version of its rubric line
+    static bool is_stale_mark(SharedData* shared, const ExamData& exam, int question) {
+        return !exam.sentinel && exam.questions_marked[question] &&
+               exam.marked_version[question] < shared->rubric_entry_version[question];
+    }
+
+    // Find a stale mark, starting each question's scan at its hint. Returns the
+    // exam slot (-1 if none) and sets question. The hints are only advanced
+    // past current marks, but a correction's reset can still be overwritten by
+    // a scan that started before it; has_stale_marks() moves them back.
+    static int find_exam_to_remark(SharedData* shared, int ta_id, int& question) {
+        for (int n = 0; n < NumQuestions; n++) {
+            // Start with the TA's own question so TAs spread over the lines
+            question = (ta_id - 1 + n) % NumQuestions;
+            int i = shared->remark_from[question];
+            while (i < shared->total_exams_loaded &&
+                   !is_stale_mark(shared, shared->exams[i], question)) {
+                i++;
+            }
+            shared->remark_from[question] = i;
+            if (i < shared->total_exams_loaded) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // Full check for stale marks before finishing, moving back any scan hint
+    // that has passed one
+    static bool has_stale_marks(SharedData* shared) {
+        bool stale = false;
+        for (int q = 0; q < NumQuestions; q++) {
+            for (int i = 0; i < shared->total_exams_loaded; i++) {
+                if (is_stale_mark(shared, shared->exams[i], q)) {
+                    if (shared->remark_from[q] > i) {
+                        shared->remark_from[q] = i;
+                    }
+                    stale = true;
+                    break;
+                }
+            }
+        }
+        return stale;
+    }
+
+    // Mark a question again under the current version of its rubric line.
+    // Only runs when there is no fresh work, so it never delays new exams.
+    static bool remark_question(SharedData* shared, int ta_id, int exam_idx, int question) {
+        ExamData& exam = shared->exams[exam_idx];
+
+        // Claim the re-mark by moving the tag to the current version; fails if
+        // another TA claimed it first
+        Sync::lock_exam(exam, ta_id);
+        int seen = exam.marked_version[question];
+        int entry_version = shared->rubric_entry_version[question];
+        bool claimed = seen < entry_version && Sync::retag(exam.marked_version[question], seen,
+                                                           entry_version);
+        int student_num = exam.student_number;
+        Sync::unlock_exam(exam);
+
+        if (!claimed) {
+            return false;
+        }
+
+        set_ta_state(ta_id, TA_STATE_REMARKING, student_num, question + 1);
+        std::cout << "[TA " << ta_id << "] Re-marking question " << (question + 1)
+                  << " for student " << student_num << " (rubric entry version " << seen
+                  << " -> " << entry_version << ")\n";
+
+        // Same marking time as the first mark (NO LOCK HELD)
+        usleep(get_random_delay(1.0, 2.0) * 1000000);
+
+        std::cout << "[TA " << ta_id << "] Finished re-marking question " << (question + 1)
+                  << " for student " << student_num << "\n";
+
+        shared->questions_remarked++;
+        bench_question_remarked();
+        if (stats != nullptr) {
+            stats->tas[ta_id].questions_remarked.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // All fresh work is claimed: only stale marks (if any) are left
+    static bool fresh_work_done(SharedData* shared) {
+        return shared->sentinel_loaded && !has_open_exams(shared);
+    }
+
+    // Publish how many exams are known, loaded and still waiting to be loaded
+    static void publish_exam_counts(SharedData* shared) {
+        if (stats == nullptr) return;
+
+        stats->exams_known.store(shared->num_exam_files, std::memory_order_relaxed);
+        stats->exams_loaded.store(shared->total_exams_loaded, std::memory_order_relaxed);
+        stats->loader_queue.store(shared->num_exam_files - shared->next_exam_to_load,
+                                  std::memory_order_relaxed);
+    }
+
+    // TA process main function
+    static void ta_process(SharedData* shared, int ta_id) {
+        std::cout << "[TA " << ta_id << "] Started working\n";
+        if (stats != nullptr) {
+            stats->tas[ta_id].pid.store(getpid(), std::memory_order_relaxed);
+        }
+
+        while (!shared->all_done && !shared->ta_retire[ta_id]) {
+            // Step 1: Review rubric (frozen once every exam is claimed, so the
+            // re-marks left at the end are a finite amount of work)
+            if (!fresh_work_done(shared)) {
+                review_and_correct_rubric(shared, ta_id);
+            }
+
+            // Step 2: Find an exam to mark
+            set_ta_state(ta_id, TA_STATE_FINDING_EXAM);
+            int exam_idx = find_exam_to_mark(shared, ta_id);
+
+            // No exams available (or the policy wants more open), try to load
+            // the next one. AtomicSync skips this if another TA is loading.
+            if ((exam_idx == -1 || wants_more_open_exams(shared)) &&
+                Sync::begin_load(*shared, ta_id, true)) {
+                // Double-check after acquiring lock. Without a loader lock that
+                // would only narrow the race, so NoSync loads from its first look.
+                if (Sync::recheck_on_load) {
+                    exam_idx = find_exam_to_mark(shared, ta_id);
+                }
+                if ((exam_idx == -1 || wants_more_open_exams(shared)) &&
+                    !shared->sentinel_loaded &&
+                    shared->next_exam_to_load < shared->num_exam_files) {
+                    int next_idx = shared->next_exam_to_load;
+                    shared->next_exam_to_load++;
+
+                    std::string source = exam_source_name(shared, next_idx);
+                    std::cout << "[TA " << ta_id << "] Loading " << source << " into shared memory\n";
+                    set_ta_state(ta_id, TA_STATE_LOADING_EXAM);
+
+                    int slot = shared->total_exams_loaded;
+                    if (slot < MAX_EXAMS && load_exam(shared, next_idx, slot)) {
+                        shared->total_exams_loaded++;
+                        shared->race().exam_file_loaded(next_idx);
+
+                        // Check if this is the termination exam
+                        if (shared->exams[slot].sentinel) {
+                            shared->sentinel_loaded = true;
+                        }
+                    }
+                    publish_exam_counts(shared);
+                }
+
+                // Finish once student 9999 is loaded, every other question is
+                // claimed and no mark is stale (TAs still marking finish their
+                // question first). The final check holds the rubric write lock so
+                // a correction cannot make a mark stale between it and all_done.
+                if (!shared->all_done && fresh_work_done(shared) && !has_stale_marks(shared)) {
+                    Sync::begin_write(*shared, ta_id);
+                    if (!has_stale_marks(shared)) {
+                        std::cout << "[TA " << ta_id << "] Found student 9999 - signaling completion\n";
+                        shared->all_done = true;
+                    }
+                    Sync::end_write(*shared);
+                }
+
+                Sync::end_load(*shared);
+            }
+
+            bool remarked = false;
+            if (exam_idx == -1 && !has_open_exams(shared)) {
+                // No fresh work: re-mark a question marked under an old rubric line
+                int question;
+                int remark_idx = find_exam_to_remark(shared, ta_id, question);
+                if (remark_idx != -1) {
+                    remarked = remark_question(shared, ta_id, remark_idx, question);
+                }
+            }
+
+            if (exam_idx == -1 && !remarked &&
+                shared->next_exam_to_load >= shared->num_exam_files) {
+                usleep(100000);  // Wait if no work available
+            }
+
+            if (exam_idx != -1) {
+                // Step 3: Mark one question on the exam
+                mark_one_question(shared, ta_id, exam_idx);
+            }
+
+            set_ta_state(ta_id, TA_STATE_RESTING);
+            usleep(50000);  // Small delay
+        }
+
+        set_ta_state(ta_id, TA_STATE_STOPPED);
+        if (shared->ta_retire[ta_id] && !shared->all_done) {
+            std::cout << "[TA " << ta_id << "] Retired by supervisor\n";
+        } else {
+            std::cout << "[TA " << ta_id << "] Finished working\n";
+        }
+    }
+
+    // Where an exam goes in the priority policy's load order: the highest
+    // priority student first, and the termination exam (it ends the run) last
+    static int load_rank(int student_num, bool sentinel) {
+        return sentinel ? INT_MIN : student_priority(student_num);
+    }
+
+    // Load rank of each exam file, or nothing when the policy loads in name order
+    static std::map<std::string, int> rank_exam_files(const std::vector<std::string>& files) {
+        std::map<std::string, int> ranks;
+        if (scheduler->kind != SCHEDULER_PRIORITY) return ranks;
+
+        for (const std::string& file : files) {
+            int student_num = read_exam_student_number(file);
+            ranks[file] = load_rank(student_num, student_num == 9999);
+        }
+        return ranks;
+    }
+
+    // Put exam files (in name order) into load order. Ties keep name order.
+    static void order_exam_files(std::vector<std::string>& files,
+                                 const std::map<std::string, int>& ranks) {
+        if (ranks.empty()) return;
+        std::stable_sort(files.begin(), files.end(),
+                         [&](const std::string& a, const std::string& b) {
+                             return ranks.at(a) > ranks.at(b);
+                         });
+    }
+
+    // Load order of the archive entries: index order (sentinel last), or by
+    // rank for the priority policy
+    static void order_archive(int num_exams) {
+        archive_load_order.resize(num_exams);
+        std::iota(archive_load_order.begin(), archive_load_order.end(), 0);
+        if (scheduler->kind != SCHEDULER_PRIORITY) return;
+
+        auto rank = [](int entry_idx) {
+            const ExamArchiveEntry& entry = exam_archive.entries[entry_idx];
+            return load_rank(entry.student_number, entry.flags & EXAM_FLAG_SENTINEL);
+        };
+        std::stable_sort(archive_load_order.begin(), archive_load_order.end(),
+                         [&](int a, int b) { return rank(a) > rank(b); });
+    }
+
+    // Get list of exam files, in load order
+    static void get_exam_files(SharedData* shared) {
+        std::vector<std::string> files = list_exam_files();
+        order_exam_files(files, rank_exam_files(files));
+
+        shared->num_exam_files = std::min((int)files.size(), MAX_EXAMS);
+        for (int i = 0; i < shared->num_exam_files; i++) {
+            strncpy(shared->exam_filenames[i], files[i].c_str(), 255);
+            shared->exam_filenames[i][255] = '\0';
+        }
+
+        std::cout << "Found " << shared->num_exam_files << " exam files\n";
+    }
+
+    // Pick up exam files that arrived after start-up. Files already loaded keep
+    // their place; the rest of the list is every file not loaded yet, in load
+    // order. The directory scan and the ranking happen without the loader
+    // lock, which is only taken when there are new files, to write the tail.
+    static void rescan_exam_files(SharedData* shared) {
+        std::vector<std::string> files = list_exam_files();
+
+        // Files not loaded yet, in load order
+        auto unloaded = [&](int next, const std::map<std::string, int>& ranks) {
+            std::set<std::string> loaded(shared->exam_filenames, shared->exam_filenames + next);
+            std::vector<std::string> rest;
+            for (const std::string& file : files) {
+                if (loaded.count(file) == 0) rest.push_back(file);
+            }
+            order_exam_files(rest, ranks);
+            return rest;
+        };
+
+        int next = shared->next_exam_to_load;
+        int old_count = shared->num_exam_files;
+        std::map<std::string, int> no_ranks;
+        if ((int)unloaded(next, no_ranks).size() <= old_count - next) {
+            return;  // Nothing new (the supervisor is the only writer of the list)
+        }
+        std::map<std::string, int> ranks = rank_exam_files(files);
+
+        Sync::begin_load(*shared, 0, false);
+
+        // TAs may have loaded more files since the check above
+        next = shared->next_exam_to_load;
+        int count = next;
+        std::vector<std::string> rest = unloaded(next, ranks);
+        for (auto file = rest.begin(); file != rest.end() && count < MAX_EXAMS; ++file) {
+            strncpy(shared->exam_filenames[count], file->c_str(), 255);
+            shared->exam_filenames[count][255] = '\0';
+            count++;
+        }
+        shared->num_exam_files = count;
+        publish_exam_counts(shared);
+
+        Sync::end_load(*shared);
+
+        if (count > old_count) {
+            std::cout << "[Supervisor] Found " << (count - old_count) << " new exam files\n";
+        }
+    }
+
+    // Questions still waiting for a TA: unclaimed questions of the loaded exams
+    // plus every question of the exams not loaded yet. Read without locks, which
+    // is fine for a scaling heuristic.
+    static int count_backlog(SharedData* shared) {
+        int backlog = 0;
+        int loaded = shared->total_exams_loaded;
+
+        for (int i = first_slot_to_scan(shared); i < loaded; i++) {
+            if (!shared->exams[i].sentinel) {
+                backlog += unclaimed_questions(shared->exams[i]);
+            }
+        }
+
+        int not_loaded = shared->num_exam_files - shared->next_exam_to_load;
+        return backlog + not_loaded * NumQuestions;
+    }
+
+    // Fork a TA using the lowest free id
+    static bool start_ta(SharedData* shared, TaPool& pool) {
+        int ta_id = 1;
+        while (ta_id <= MAX_TAS && pool.pids[ta_id] != 0) {
+            ta_id++;
+        }
+        if (ta_id > MAX_TAS) return false;
+
+        shared->ta_retire[ta_id] = false;
+        std::cout.flush();  // Otherwise the child inherits and repeats buffered output
+        pid_t pid = fork();
+        if (pid == 0) {
+            // Child process
+            ta_process(shared, ta_id);
+            exit(0);
+        } else if (pid < 0) {
+            perror("fork");
+            return false;
+        }
+
+        pool.pids[ta_id] = pid;
+        if (stats != nullptr) {
+            stats->tas[ta_id].pid.store(pid, std::memory_order_relaxed);
+        }
+        pool.running++;
+        pool.active++;
+        return true;
+    }
+
+    // Ask the active TA with the highest id to stop after its current step
+    static void retire_ta(SharedData* shared, TaPool& pool) {
+        for (int ta_id = MAX_TAS; ta_id >= 1; ta_id--) {
+            if (pool.pids[ta_id] != 0 && !shared->ta_retire[ta_id]) {
+                std::cout << "[Supervisor] Retiring TA " << ta_id << "\n";
+                shared->ta_retire[ta_id] = true;
+                pool.active--;
+                return;
+            }
+        }
+    }
+
+    // Collect TAs that have exited
+    static void reap_tas(SharedData* shared, TaPool& pool) {
+        pid_t pid;
+        while ((pid = waitpid(-1, NULL, WNOHANG)) > 0) {
+            for (int ta_id = 1; ta_id <= MAX_TAS; ta_id++) {
+                if (pool.pids[ta_id] != pid) continue;
+
+                if (!shared->ta_retire[ta_id]) {
+                    // Exited without being asked to (done, or crashed)
+                    pool.active--;
+                }
+                pool.pids[ta_id] = 0;
+                pool.running--;
+                break;
+            }
+        }
+    }
+
+    // Wait for every TA to exit (they stop after their current step)
+    static void wait_for_tas(TaPool& pool) {
+        for (int ta_id = 1; ta_id <= MAX_TAS; ta_id++) {
+            if (pool.pids[ta_id] != 0) {
+                waitpid(pool.pids[ta_id], NULL, 0);
+                pool.pids[ta_id] = 0;
+            }
+        }
+        pool.running = 0;
+        pool.active = 0;
+        if (stats != nullptr) {
+            stats->active_tas.store(0, std::memory_order_relaxed);
+            stats->all_done.store(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Keep the number of TAs between min_tas and max_tas, tracking the backlog,
+    // until the TAs signal completion
+    static void supervise_tas(SharedData* shared, TaPool& pool, bool rescan) {
+        int low_demand_checks = 0;
+        int checks = 0;
+
+        // SIGCHLD stays pending while blocked, so sigtimedwait() below wakes the
+        // supervisor as soon as a TA exits (TAs exit right after all_done is set)
+        sigset_t sigchld, old_mask;
+        sigemptyset(&sigchld);
+        sigaddset(&sigchld, SIGCHLD);
+        sigprocmask(SIG_BLOCK, &sigchld, &old_mask);
+
+        while (!shared->all_done) {
+            reap_tas(shared, pool);
+
+            if (rescan && ++checks % RESCAN_EVERY_CHECKS == 0) {
+                rescan_exam_files(shared);
+            }
+
+            int backlog = count_backlog(shared);
+            int wanted = (backlog + QUESTIONS_PER_TA - 1) / QUESTIONS_PER_TA;
+            wanted = std::max(pool.min_tas, std::min(pool.max_tas, wanted));
+
+            if (pool.active < wanted) {
+                if (pool.min_tas != pool.max_tas) {
+                    std::cout << "[Supervisor] Backlog " << backlog << " questions, scaling "
+                              << pool.active << " -> " << wanted << " TAs\n";
+                }
+                while (pool.active < wanted && start_ta(shared, pool)) {
+                }
+                low_demand_checks = 0;
+            } else if (pool.active > wanted) {
+                // Only retire once demand has stayed low for a while
+                if (++low_demand_checks >= RETIRE_AFTER_CHECKS) {
+                    retire_ta(shared, pool);
+                    low_demand_checks = 0;
+                }
+            } else {
+                low_demand_checks = 0;
+            }
+
+            if (stats != nullptr) {
+                stats->active_tas.store(pool.active, std::memory_order_relaxed);
+            }
+            // Real time, not usleep(): the benchmark scales the TAs' usleep()
+            // calls down to a yield, which would turn this into a busy loop
+            struct timespec interval = {0, SUPERVISOR_INTERVAL_US * 1000L};
+            sigtimedwait(&sigchld, NULL, &interval);
+        }
+
+        wait_for_tas(pool);
+        sigprocmask(SIG_SETMASK, &old_mask, NULL);
+    }
+
+    // Print how long exams took from being loaded to being fully marked
+    static void print_completion_stats(SharedData* shared) {
+        std::vector<double> times;
+        double first_done = 0, last_done = 0;
+        for (int i = 0; i < shared->total_exams_loaded; i++) {
+            const ExamData& exam = shared->exams[i];
+            if (exam.sentinel || exam.done_time == 0) continue;
+
+            times.push_back(exam.done_time - exam.load_time);
+            if (first_done == 0 || exam.done_time < first_done) first_done = exam.done_time;
+            if (exam.done_time > last_done) last_done = exam.done_time;
+        }
+        if (times.empty()) return;
+
+        std::sort(times.begin(), times.end());
+        double total = 0;
+        for (double t : times) total += t;
+
+        std::cout << "\n=== Exam completion times (" << scheduler->name << ") ===\n";
+        std::cout << "Exams fully marked: " << times.size() << "\n";
+        std::cout << "Load to fully marked: mean " << total / times.size() << "s, p50 "
+                  << times[times.size() / 2] << "s, p95 " << times[(times.size() - 1) * 95 / 100]
+                  << "s, max " << times.back() << "s\n";
+        std::cout << "First exam fully marked after " << first_done - shared->start_time
+                  << "s, last after " << last_done - shared->start_time << "s\n";
+    }
+
+    // Set up shared memory, fork the TAs and wait for them all to finish.
+    // The pool starts at min_tas and may grow to max_tas as the backlog requires.
+    // archive_path selects a packed exam archive instead of the exam_*.txt files.
+    static int run_marking_system(int min_tas, int max_tas, const char* archive_path) {
+        srand(time(NULL));
+
+        // Create shared memory. Any stale segment is unlinked first so the new
+        // one starts out zero-filled and only the pages we use get touched.
+        shm_unlink("/ta_marking_shm");
+        int shm_fd = shm_open("/ta_marking_shm", O_CREAT | O_RDWR, 0666);
+        if (shm_fd == -1) {
+            perror("shm_open");
+            return 1;
+        }
+
+        ftruncate(shm_fd, sizeof(SharedData));
+
+        SharedData* shared = (SharedData*)mmap(NULL, sizeof(SharedData),
+                                               PROT_READ | PROT_WRITE,
+                                               MAP_SHARED, shm_fd, 0);
+        if (shared == MAP_FAILED) {
+            perror("mmap");
+            return 1;
+        }
+
+        // Initialize shared memory
+        shared->all_done = false;
+        shared->total_exams_loaded = 0;
+        shared->next_exam_to_load = 0;
+        shared->rubric_version = 0;
+        shared->start_time = now_seconds();
+        Sync::init(*shared);
+
+        // Stats page for ta_top; marking goes ahead without it if it can't be created
+        stats = create_stats_page(max_tas, scheduler->name);
+
+        // Load rubric
+        std::cout << "Loading rubric into shared memory...\n";
+        std::vector<std::string> rubric_lines;
+        if (!load_rubric(rubric_lines)) {
+            return 1;
+        }
+        copy_rubric(shared->rubric, rubric_lines);
+
+        // Optional per-student priorities for the priority policy
+        load_priorities();
+
+        // Get list of exams: from the archive index, or by scanning for exam files
+        if (archive_path != nullptr) {
+            if (!open_exam_archive(archive_path, exam_archive)) {
+                return 1;
+            }
+            shared->num_exam_files = std::min((int)exam_archive.header->num_exams, MAX_EXAMS);
+            order_archive(exam_archive.header->num_exams);
+            std::cout << "Found " << shared->num_exam_files << " exams in " << archive_path << "\n";
+        } else {
+            get_exam_files(shared);
+        }
+
+        // Load first exam
+        if (shared->num_exam_files > 0) {
+            std::cout << "Loading first exam into shared memory...\n";
+            load_exam(shared, 0, 0);
+            shared->race().exam_file_loaded(0);
+            shared->total_exams_loaded = 1;
+            shared->next_exam_to_load = 1;
+            std::cout << "First exam: Student " << shared->exams[0].student_number << "\n\n";
+            publish_exam_counts(shared);
+        } else {
+            std::cerr << "Error: No exam files found\n";
+            return 1;
+        }
+
+        // Create TA processes
+        TaPool pool;
+        memset(&pool, 0, sizeof(pool));
+        pool.min_tas = min_tas;
+        pool.max_tas = max_tas;
+        for (int i = 0; i < min_tas; i++) {
+            if (!start_ta(shared, pool)) {
+                return 1;
+            }
+        }
+
+        // A fixed pool just waits for its TAs. An adaptive one is supervised
+        // until they are all finished; new exam files are only picked up when
+        // not reading from an archive.
+        if (min_tas == max_tas) {
+            if (stats != nullptr) {
+                stats->active_tas.store(pool.active, std::memory_order_relaxed);
+            }
+            wait_for_tas(pool);
+        } else {
+            supervise_tas(shared, pool, archive_path == nullptr);
+        }
+
+        std::cout << "\n=== All TAs finished ===\n";
+        std::cout << "Total exams processed: " << shared->total_exams_loaded << "\n";
+        print_completion_stats(shared);
+        std::cout << "Questions re-marked after rubric corrections: "
+                  << shared->questions_remarked << "\n";
+
+        if (Sync::race_accounting) {
+            RaceCounts race_counts = shared->race().impact(shared);
+            print_race_impact(race_counts);
+            bench_race_counts(race_counts);
+        }
+
+        // Cleanup locks
+        Sync::destroy(*shared);
+        for (int i = 0; i < shared->total_exams_loaded; i++) {
+            Sync::destroy_exam(shared->exams[i]);
+        }
+
+        // Cleanup
+        close_exam_archive(exam_archive);
+        if (stats != nullptr) {
+            close_stats_page(stats);
+            stats = nullptr;
+            shm_unlink(TA_STATS_SHM_NAME);
+        }
+        munmap(shared, sizeof(SharedData));
+        close(shm_fd);
+        shm_unlink("/ta_marking_shm");
+
+        return 0;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Command line shared by the part_a and part_b programs
+// ---------------------------------------------------------------------------
+
+struct EngineArgs {
+    int min_tas;
+    int max_tas;
+    bool adaptive;
+    bool lockfree;             // --lockfree (only if the program allows it)
+    const char* archive_path;  // NULL to read exam_*.txt files
+};
+
+// Parse [--lockfree] [--policy NAME] (<number_of_TAs> | --adaptive <min> <max>)
+// [exam_archive]. Prints the problem and returns false on bad arguments.
+inline bool parse_engine_args(int argc, char* argv[], bool allow_lockfree, EngineArgs& out) {
+    out.min_tas = out.max_tas = 0;
+    out.adaptive = false;
+    out.lockfree = false;
+    out.archive_path = nullptr;
+
+    std::vector<const char*> args;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--adaptive") == 0 && i + 2 < argc) {
+            out.adaptive = true;
+            out.min_tas = atoi(argv[++i]);
+            out.max_tas = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--lockfree") == 0 && allow_lockfree) {
+            out.lockfree = true;
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            if (!set_scheduler(argv[++i])) {
+                std::cerr << "Error: Unknown policy '" << argv[i] << "'. Policies:\n";
+                for (const auto& policy : SCHEDULERS) {
+                    std::cerr << "  " << policy.name << " - " << policy.description << "\n";
+                }
+                return false;
+            }
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    size_t num_required = out.adaptive ? 0 : 1;
+    if (args.size() != num_required && args.size() != num_required + 1) {
+        const char* lockfree = allow_lockfree ? " [--lockfree]" : "";
+        std::cerr << "Usage: " << argv[0] << lockfree
+                  << " [--policy NAME] <number_of_TAs> [exam_archive]\n"
+                  << "       " << argv[0] << lockfree
+                  << " [--policy NAME] --adaptive <min_TAs> <max_TAs> [exam_archive]\n";
+        return false;
+    }
+    out.archive_path = args.size() > num_required ? args.back() : nullptr;
+
+    if (out.adaptive) {
+        if (out.min_tas < 1 || out.max_tas < out.min_tas) {
+            std::cerr << "Error: Need 1 <= min_TAs <= max_TAs\n";
+            return false;
+        }
+    } else {
+        out.min_tas = out.max_tas = atoi(args[0]);
+        if (out.min_tas < 2) {
+            std::cerr << "Error: Must have at least 2 TAs\n";
+            return false;
+        }
+    }
+    if (out.max_tas > MAX_TAS) {
+        std::cerr << "Error: At most " << MAX_TAS << " TAs\n";
+        return false;
+    }
+    return true;
+}
+
+// Print the TA count and scheduling policy under a program's banner
+inline void print_engine_args(const EngineArgs& args) {
+    if (args.adaptive) {
+        std::cout << "Number of TAs: " << args.min_tas << " to " << args.max_tas << " (adaptive)\n";
+    } else {
+        std::cout << "Number of TAs: " << args.min_tas << "\n";
+    }
+    std::cout << "Scheduling policy: " << scheduler->name << "\n\n";
+}
+
+#endif  // TA_MARKING_ENGINE_H
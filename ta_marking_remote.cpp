@@ -0,0 +1,710 @@
+/**
+ * @file ta_marking_remote.cpp
+ * @brief Distributed TA marking: a coordinator and remote TA workers
+ * @author Student 1: Bhagya Patel (101324150)
+ * @author Student 2: Oluwatobi Olowookere (101245900)
+ *
+ * Instead of sharing /ta_marking_shm on one host, the coordinator owns the
+ * exam queue and the rubric, and TAs on any number of machines connect to it
+ * over TCP or a Unix socket (protocol in ta_remote.h). Each TA leases a batch
+ * of questions, marks them and sends the results back; rubric corrections go
+ * to the coordinator, which bumps the rubric version and pushes the new rubric
+ * to every TA. Leases that time out, and the leases of TAs that disconnect,
+ * are put back at the front of the queue.
+ *
+ *   ./ta_marking_remote coordinator 127.0.0.1:5050
+ *   ./ta_marking_remote worker 127.0.0.1:5050 3      # 3 TAs, on this or another host
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+
+#include "ta_marking_common.h"
+#include "exam_archive.h"
+#include "ta_remote.h"
+
+#define NUM_QUESTIONS 5
+#define DEFAULT_LEASE_MS 30000     // Time a TA gets to finish a lease
+#define DEFAULT_MAX_BATCH 5        // Largest lease the coordinator hands out
+#define WAIT_RETRY_MS 200          // How long a TA waits when there is nothing to lease
+#define POLL_INTERVAL_MS 100       // How often the coordinator checks for expired leases
+
+// Marking state of one question held by the coordinator
+enum QuestionState {
+    QUESTION_QUEUED,
+    QUESTION_LEASED,
+    QUESTION_DONE,
+};
+
+struct RemoteExam {
+    int student_number;
+    QuestionState questions[NUM_QUESTIONS];
+    int rubric_version[NUM_QUESTIONS];  // Rubric version each question was marked with
+    int questions_completed;
+};
+
+// One question of one exam
+struct Task {
+    int exam;
+    int question;  // 0-based
+};
+
+struct Lease {
+    int ta_fd;
+    double deadline;
+    std::vector<Task> tasks;  // Not yet reported back
+};
+
+// A connected TA
+struct RemoteTa {
+    int ta_id;
+    std::string name;
+    std::string in;   // Received, not yet parsed
+    std::string out;  // Queued for sending
+    long questions_marked;
+};
+
+// Everything the coordinator owns
+struct Coordinator {
+    std::vector<std::string> rubric;
+    int rubric_version;
+
+    ExamArchive archive;              // base is NULL when reading exam files
+    std::vector<std::string> exam_files;
+    int num_exams;
+    int next_exam_to_load;
+    bool sentinel_loaded;
+
+    std::vector<RemoteExam> exams;
+    std::deque<Task> queue;
+    std::map<int, Lease> leases;      // lease id -> lease
+    std::map<int, RemoteTa> tas;      // socket -> TA
+    int next_ta_id;
+    int next_lease_id;
+
+    int lease_ms;
+    int max_batch;
+    long questions_marked;
+    long questions_requeued;
+    long duplicate_results;
+    long rubric_corrections;
+};
+
+// ---------------------------------------------------------------------------
+// Coordinator
+// ---------------------------------------------------------------------------
+
+// Read the student number of the exam_idx'th exam (-1 if it can't be read)
+int exam_student_number(Coordinator& c, int exam_idx, bool& is_sentinel) {
+    if (c.archive.base != nullptr) {
+        const ExamArchiveEntry& entry = c.archive.entries[exam_idx];
+        is_sentinel = entry.flags & EXAM_FLAG_SENTINEL;
+        return entry.student_number;
+    }
+
+    int student_num = read_exam_student_number(c.exam_files[exam_idx]);
+    is_sentinel = student_num == 9999;
+    return student_num;
+}
+
+// Load exams until the queue holds at least `wanted` questions, or until
+// student 9999 (or the end of the exam list) is reached
+void fill_queue(Coordinator& c, size_t wanted) {
+    while (c.queue.size() < wanted && !c.sentinel_loaded && c.next_exam_to_load < c.num_exams) {
+        int exam_idx = c.next_exam_to_load++;
+        bool is_sentinel = false;
+        int student_num = exam_student_number(c, exam_idx, is_sentinel);
+        if (student_num < 0) {
+            std::cerr << "[Coordinator] Skipping unreadable exam " << exam_idx << "\n";
+            continue;
+        }
+        if (is_sentinel) {
+            std::cout << "[Coordinator] Reached student 9999 - no more exams will be loaded\n";
+            c.sentinel_loaded = true;
+            break;
+        }
+
+        RemoteExam exam;
+        memset(&exam, 0, sizeof(exam));
+        exam.student_number = student_num;
+        c.exams.push_back(exam);
+        for (int q = 0; q < NUM_QUESTIONS; q++) {
+            c.queue.push_back({(int)c.exams.size() - 1, q});
+        }
+        std::cout << "[Coordinator] Loaded exam for student " << student_num << "\n";
+    }
+}
+
+// Every exam is loaded (or student 9999 reached) and every question is marked
+bool all_marked(Coordinator& c) {
+    if (!c.sentinel_loaded && c.next_exam_to_load < c.num_exams) {
+        return false;
+    }
+    return c.questions_marked == (long)c.exams.size() * NUM_QUESTIONS;
+}
+
+// Queue a message to a TA; it is written when the socket is writable
+void queue_message(RemoteTa& ta, const std::string& message) {
+    ta.out += message;
+    ta.out += '\n';
+}
+
+std::string rubric_message(Coordinator& c) {
+    return "RUBRIC " + std::to_string(c.rubric_version) + " " + join_rubric(c.rubric);
+}
+
+// Put a lease's unfinished questions back at the front of the queue
+void requeue_lease(Coordinator& c, int lease_id, const char* reason) {
+    Lease& lease = c.leases[lease_id];
+    int requeued = 0;
+    for (auto it = lease.tasks.rbegin(); it != lease.tasks.rend(); ++it) {
+        RemoteExam& exam = c.exams[it->exam];
+        if (exam.questions[it->question] == QUESTION_LEASED) {
+            exam.questions[it->question] = QUESTION_QUEUED;
+            c.queue.push_front(*it);
+            requeued++;
+        }
+    }
+    c.questions_requeued += requeued;
+
+    auto ta = c.tas.find(lease.ta_fd);
+    std::cout << "[Coordinator] Lease " << lease_id << " of TA "
+              << (ta != c.tas.end() ? ta->second.ta_id : 0) << " " << reason
+              << ", re-queuing " << requeued << " questions\n";
+    c.leases.erase(lease_id);
+}
+
+// LEASE <max_questions>
+void handle_lease(Coordinator& c, int fd, RemoteTa& ta, const std::vector<std::string>& words) {
+    int wanted = words.size() > 1 ? atoi(words[1].c_str()) : 1;
+    wanted = std::max(1, std::min(wanted, c.max_batch));
+
+    fill_queue(c, wanted);
+
+    Lease lease;
+    lease.ta_fd = fd;
+    lease.deadline = now_seconds() + c.lease_ms / 1000.0;
+    while ((int)lease.tasks.size() < wanted && !c.queue.empty()) {
+        Task task = c.queue.front();
+        c.queue.pop_front();
+
+        // A late result may have finished a question that was re-queued
+        QuestionState& state = c.exams[task.exam].questions[task.question];
+        if (state != QUESTION_QUEUED) continue;
+
+        state = QUESTION_LEASED;
+        lease.tasks.push_back(task);
+        if (c.queue.empty()) {
+            fill_queue(c, wanted - lease.tasks.size());
+        }
+    }
+
+    if (lease.tasks.empty()) {
+        // Either everything is marked, or the rest is leased to other TAs
+        queue_message(ta, all_marked(c) ? "DONE" : "WAIT " + std::to_string(WAIT_RETRY_MS));
+        return;
+    }
+
+    int lease_id = ++c.next_lease_id;
+    std::string message = "BATCH " + std::to_string(lease_id);
+    for (const auto& task : lease.tasks) {
+        message += " " + std::to_string(task.exam) + ":" +
+                   std::to_string(c.exams[task.exam].student_number) + ":" +
+                   std::to_string(task.question + 1);
+    }
+    c.leases[lease_id] = lease;
+    queue_message(ta, message);
+}
+
+// RESULT <lease_id> <exam> <question> <rubric_version>
+void handle_result(Coordinator& c, RemoteTa& ta, const std::vector<std::string>& words) {
+    if (words.size() < 5) return;
+    int lease_id = atoi(words[1].c_str());
+    int exam_idx = atoi(words[2].c_str());
+    int question = atoi(words[3].c_str()) - 1;
+    int version = atoi(words[4].c_str());
+    if (exam_idx < 0 || exam_idx >= (int)c.exams.size() ||
+        question < 0 || question >= NUM_QUESTIONS) {
+        return;
+    }
+
+    RemoteExam& exam = c.exams[exam_idx];
+    if (exam.questions[question] == QUESTION_DONE) {
+        // Marked twice: the lease expired and another TA got there first
+        c.duplicate_results++;
+    } else {
+        exam.questions[question] = QUESTION_DONE;
+        exam.rubric_version[question] = version;
+        exam.questions_completed++;
+        c.questions_marked++;
+        ta.questions_marked++;
+        if (exam.questions_completed == NUM_QUESTIONS) {
+            std::cout << "[Coordinator] Student " << exam.student_number
+                      << " fully marked\n";
+        }
+    }
+
+    // A result is also a heartbeat for the rest of its lease
+    auto lease = c.leases.find(lease_id);
+    if (lease != c.leases.end()) {
+        auto& tasks = lease->second.tasks;
+        for (auto it = tasks.begin(); it != tasks.end(); ++it) {
+            if (it->exam == exam_idx && it->question == question) {
+                tasks.erase(it);
+                break;
+            }
+        }
+        lease->second.deadline = now_seconds() + c.lease_ms / 1000.0;
+        if (tasks.empty()) {
+            c.leases.erase(lease);
+        }
+    }
+}
+
+// CORRECT <question> <rubric_version>: same correction as the shared memory
+// engine (bump the answer letter), then push the new rubric to every TA
+void handle_correct(Coordinator& c, RemoteTa& ta, const std::vector<std::string>& words) {
+    if (words.size() < 3) return;
+    int question = atoi(words[1].c_str()) - 1;
+    int seen_version = atoi(words[2].c_str());
+    if (question < 0 || question >= (int)c.rubric.size()) return;
+
+    char old_char, new_char;
+    if (!correct_rubric_line(c.rubric[question], old_char, new_char)) return;
+    c.rubric_version++;
+    c.rubric_corrections++;
+    save_rubric(c.rubric);
+
+    std::cout << "[Coordinator] TA " << ta.ta_id << " changed '" << old_char << "' to '"
+              << new_char << "' in question " << (question + 1)
+              << " (rubric version " << c.rubric_version;
+    if (seen_version != c.rubric_version - 1) {
+        std::cout << ", TA had seen version " << seen_version;
+    }
+    std::cout << ")\n";
+
+    std::string message = rubric_message(c);
+    for (auto& other : c.tas) {
+        queue_message(other.second, message);
+    }
+}
+
+void handle_message(Coordinator& c, int fd, const std::string& line) {
+    RemoteTa& ta = c.tas[fd];
+    std::vector<std::string> words = split_words(line);
+    if (words.empty()) return;
+
+    if (words[0] == "HELLO") {
+        ta.ta_id = ++c.next_ta_id;
+        ta.name = words.size() > 1 ? words[1] : "?";
+        std::cout << "[Coordinator] TA " << ta.ta_id << " connected (" << ta.name << ")\n";
+        queue_message(ta, "WELCOME " + std::to_string(ta.ta_id) + " " +
+                              std::to_string(c.lease_ms));
+        queue_message(ta, rubric_message(c));
+    } else if (words[0] == "LEASE") {
+        handle_lease(c, fd, ta, words);
+    } else if (words[0] == "RESULT") {
+        handle_result(c, ta, words);
+    } else if (words[0] == "CORRECT") {
+        handle_correct(c, ta, words);
+    } else {
+        std::cerr << "[Coordinator] Unknown message from TA " << ta.ta_id << ": " << line << "\n";
+    }
+}
+
+// Drop a TA, handing its leases to someone else
+void disconnect_ta(Coordinator& c, int fd) {
+    std::vector<int> orphaned;
+    for (const auto& lease : c.leases) {
+        if (lease.second.ta_fd == fd) {
+            orphaned.push_back(lease.first);
+        }
+    }
+    for (int lease_id : orphaned) {
+        requeue_lease(c, lease_id, "lost its TA");
+    }
+
+    std::cout << "[Coordinator] TA " << c.tas[fd].ta_id << " disconnected after marking "
+              << c.tas[fd].questions_marked << " questions\n";
+    c.tas.erase(fd);
+    close(fd);
+}
+
+// Re-queue every lease that has run past its deadline
+void expire_leases(Coordinator& c) {
+    double now = now_seconds();
+    std::vector<int> expired;
+    for (const auto& lease : c.leases) {
+        if (lease.second.deadline < now) {
+            expired.push_back(lease.first);
+        }
+    }
+    for (int lease_id : expired) {
+        requeue_lease(c, lease_id, "timed out");
+    }
+}
+
+// Write as much queued output as the socket takes. Returns false on error.
+bool flush_ta(int fd, RemoteTa& ta) {
+    while (!ta.out.empty()) {
+        ssize_t n = send(fd, ta.out.data(), ta.out.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (n <= 0) return false;
+        ta.out.erase(0, n);
+    }
+    return true;
+}
+
+int run_coordinator(const RemoteAddress& address, const char* archive_path, int lease_ms,
+                    int max_batch) {
+    Coordinator c;
+    memset(&c.archive, 0, sizeof(c.archive));
+    c.rubric_version = 0;
+    c.num_exams = 0;
+    c.next_exam_to_load = 0;
+    c.sentinel_loaded = false;
+    c.next_ta_id = 0;
+    c.next_lease_id = 0;
+    c.lease_ms = lease_ms;
+    c.max_batch = max_batch;
+    c.questions_marked = 0;
+    c.questions_requeued = 0;
+    c.duplicate_results = 0;
+    c.rubric_corrections = 0;
+
+    std::cout << "Loading rubric...\n";
+    if (!load_rubric(c.rubric)) {
+        return 1;
+    }
+
+    if (archive_path != nullptr) {
+        if (!open_exam_archive(archive_path, c.archive)) {
+            return 1;
+        }
+        c.num_exams = c.archive.header->num_exams;
+        std::cout << "Found " << c.num_exams << " exams in " << archive_path << "\n";
+    } else {
+        c.exam_files = list_exam_files();
+        c.num_exams = c.exam_files.size();
+        std::cout << "Found " << c.num_exams << " exam files\n";
+    }
+    if (c.num_exams == 0) {
+        std::cerr << "Error: No exam files found\n";
+        return 1;
+    }
+
+    int listen_fd = remote_listen(address);
+    if (listen_fd == -1) {
+        return 1;
+    }
+    std::cout << "Waiting for TAs (lease " << lease_ms << "ms, batches of up to "
+              << max_batch << " questions)\n\n";
+
+    double start = 0;
+    double finish_deadline = 0;
+    while (true) {
+        if (finish_deadline == 0 && all_marked(c)) {
+            // Tell every TA to stop, then give them one lease period to disconnect
+            for (auto& ta : c.tas) {
+                queue_message(ta.second, "DONE");
+            }
+            finish_deadline = now_seconds() + c.lease_ms / 1000.0;
+        }
+        if (finish_deadline > 0 && (c.tas.empty() || now_seconds() > finish_deadline)) {
+            break;
+        }
+
+        std::vector<pollfd> fds;
+        fds.push_back({listen_fd, POLLIN, 0});
+        for (const auto& ta : c.tas) {
+            short events = POLLIN;
+            if (!ta.second.out.empty()) events |= POLLOUT;
+            fds.push_back({ta.first, events, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), POLL_INTERVAL_MS) == -1 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listen_fd, NULL, NULL);
+            if (fd != -1) {
+                RemoteTa ta;
+                ta.ta_id = 0;
+                ta.questions_marked = 0;
+                c.tas[fd] = ta;
+                if (start == 0) start = now_seconds();
+            }
+        }
+
+        for (size_t i = 1; i < fds.size(); i++) {
+            int fd = fds[i].fd;
+            if (c.tas.count(fd) == 0 || fds[i].revents == 0) continue;
+            RemoteTa& ta = c.tas[fd];
+
+            bool ok = true;
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                char chunk[4096];
+                ssize_t n = recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+                if (n > 0) {
+                    ta.in.append(chunk, n);
+                    std::string line;
+                    while (take_line(ta.in, line)) {
+                        handle_message(c, fd, line);
+                    }
+                    ok = ta.in.size() <= REMOTE_MAX_LINE;
+                } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                    ok = false;
+                }
+            }
+            if (ok) {
+                ok = flush_ta(fd, ta);
+            }
+            if (!ok) {
+                disconnect_ta(c, fd);
+            }
+        }
+
+        expire_leases(c);
+    }
+
+    for (auto& ta : c.tas) {
+        close(ta.first);
+    }
+    close(listen_fd);
+    if (address.is_unix) {
+        unlink(address.path.c_str());
+    }
+    close_exam_archive(c.archive);
+
+    std::cout << "\n=== All exams marked ===\n";
+    std::cout << "Exams marked: " << c.exams.size() << " (" << c.questions_marked
+              << " questions) in " << (start > 0 ? now_seconds() - start : 0.0) << "s\n";
+    std::cout << "TAs connected: " << c.next_ta_id << ", leases granted: " << c.next_lease_id
+              << "\n";
+    std::cout << "Questions re-queued: " << c.questions_requeued
+              << ", duplicate results ignored: " << c.duplicate_results << "\n";
+    std::cout << "Rubric corrections: " << c.rubric_corrections << " (final version "
+              << c.rubric_version << ")\n";
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Worker
+// ---------------------------------------------------------------------------
+
+// A remote TA's view of the coordinator
+struct RemoteSession {
+    int fd;
+    std::string buffer;
+    int ta_id;
+    std::vector<std::string> rubric;
+    int rubric_version;
+};
+
+// Read messages until one that isn't a rubric update arrives. Rubric updates
+// can be pushed at any time and are applied as they are read.
+bool next_reply(RemoteSession& session, std::vector<std::string>& words) {
+    std::string line;
+    while (remote_receive(session.fd, session.buffer, line)) {
+        if (line.compare(0, 7, "RUBRIC ") == 0) {
+            size_t space = line.find(' ', 7);
+            session.rubric_version = atoi(line.substr(7, space - 7).c_str());
+            session.rubric = space == std::string::npos
+                                 ? std::vector<std::string>()
+                                 : split_rubric(line.substr(space + 1));
+            continue;
+        }
+        words = split_words(line);
+        if (!words.empty()) return true;
+    }
+    return false;
+}
+
+// Review the local copy of the rubric; send a correction if an error is found
+bool review_rubric(RemoteSession& session, double delay_scale) {
+    int ta_id = session.ta_id;
+    std::cout << "[TA " << ta_id << "] Reading rubric (version " << session.rubric_version
+              << ")\n";
+
+    for (size_t i = 0; i < session.rubric.size() && i < NUM_QUESTIONS; i++) {
+        usleep(get_random_delay(0.5, 1.0) * delay_scale * 1000000);
+
+        // Randomly decide if correction needed
+        if (rand() % 100 < 30) {
+            std::cout << "[TA " << ta_id << "] Detected error in rubric question " << (i+1)
+                      << ", sending correction\n";
+            return remote_send(session.fd, "CORRECT " + std::to_string(i + 1) + " " +
+                                               std::to_string(session.rubric_version));
+        }
+    }
+    return true;
+}
+
+// One remote TA: review the rubric, lease a batch, mark it, repeat
+int remote_ta(const RemoteAddress& address, int batch, double delay_scale) {
+    srand(time(NULL) ^ getpid());
+
+    RemoteSession session;
+    session.fd = remote_connect(address);
+    session.ta_id = 0;
+    session.rubric_version = 0;
+    if (session.fd == -1) {
+        return 1;
+    }
+
+    char host[64] = "worker";
+    gethostname(host, sizeof(host) - 1);
+    std::vector<std::string> words;
+    if (!remote_send(session.fd, "HELLO " + std::string(host) + "/" + std::to_string(getpid())) ||
+        !next_reply(session, words) || words[0] != "WELCOME" || words.size() < 2) {
+        std::cerr << "Error: Coordinator did not accept the connection\n";
+        close(session.fd);
+        return 1;
+    }
+    session.ta_id = atoi(words[1].c_str());
+    int ta_id = session.ta_id;
+    std::cout << "[TA " << ta_id << "] Started working\n";
+
+    long marked = 0;
+    bool connected = true;
+    while (connected) {
+        // Step 1: Review rubric
+        connected = review_rubric(session, delay_scale);
+
+        // Step 2: Lease a batch of questions
+        connected = connected && remote_send(session.fd, "LEASE " + std::to_string(batch)) &&
+                    next_reply(session, words);
+        if (!connected) break;
+
+        if (words[0] == "DONE") {
+            break;
+        } else if (words[0] == "WAIT") {
+            int retry_ms = words.size() > 1 ? atoi(words[1].c_str()) : WAIT_RETRY_MS;
+            usleep(retry_ms * 1000);
+            continue;
+        } else if (words[0] != "BATCH" || words.size() < 3) {
+            std::cerr << "[TA " << ta_id << "] Unexpected reply: " << words[0] << "\n";
+            continue;
+        }
+
+        // Step 3: Mark every question in the batch, reporting each one
+        const std::string& lease_id = words[1];
+        for (size_t i = 2; i < words.size() && connected; i++) {
+            int exam = 0, student = 0, question = 0;
+            if (sscanf(words[i].c_str(), "%d:%d:%d", &exam, &student, &question) != 3) continue;
+
+            std::cout << "[TA " << ta_id << "] Marking question " << question
+                      << " for student " << student << "\n";
+            usleep(get_random_delay(1.0, 2.0) * delay_scale * 1000000);
+
+            connected = remote_send(session.fd, "RESULT " + lease_id + " " +
+                                                    std::to_string(exam) + " " +
+                                                    std::to_string(question) + " " +
+                                                    std::to_string(session.rubric_version));
+            marked++;
+        }
+    }
+
+    close(session.fd);
+    std::cout << "[TA " << ta_id << "] Finished working (" << marked << " questions marked"
+              << (connected ? "" : ", lost the coordinator") << ")\n";
+    return connected ? 0 : 1;
+}
+
+// Fork num_tas remote TAs and wait for them
+int run_worker(const RemoteAddress& address, int num_tas, int batch, double delay_scale) {
+    std::vector<pid_t> pids;
+    for (int i = 0; i < num_tas; i++) {
+        std::cout.flush();  // Otherwise the child inherits and repeats buffered output
+        pid_t pid = fork();
+        if (pid == 0) {
+            exit(remote_ta(address, batch, delay_scale));
+        } else if (pid < 0) {
+            perror("fork");
+            break;
+        }
+        pids.push_back(pid);
+    }
+
+    int failures = 0;
+    for (pid_t pid : pids) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failures++;
+        }
+    }
+    return failures == 0 && (int)pids.size() == num_tas ? 0 : 1;
+}
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " coordinator <address> [exam_archive]"
+              << " [--lease-ms N] [--max-batch N]\n"
+              << "       " << prog << " worker <address> <number_of_TAs>"
+              << " [--batch N] [--delay-scale F]\n"
+              << "Address: <host>:<port> or unix:<path>\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    std::string mode = argv[1];
+    RemoteAddress address;
+    if (!parse_remote_address(argv[2], address)) {
+        std::cerr << "Error: Bad address '" << argv[2] << "'\n";
+        return 1;
+    }
+
+    int lease_ms = DEFAULT_LEASE_MS;
+    int max_batch = DEFAULT_MAX_BATCH;
+    int batch = NUM_QUESTIONS;
+    double delay_scale = 1.0;
+    std::vector<const char*> args;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--lease-ms") == 0 && i + 1 < argc) {
+            lease_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-batch") == 0 && i + 1 < argc) {
+            max_batch = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--delay-scale") == 0 && i + 1 < argc) {
+            delay_scale = atof(argv[++i]);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    if (mode == "coordinator" && args.size() <= 1 && lease_ms > 0 && max_batch > 0) {
+        std::cout << "=== TA Marking System (distributed coordinator) ===\n";
+        return run_coordinator(address, args.empty() ? nullptr : args[0], lease_ms, max_batch);
+    }
+    if (mode == "worker" && args.size() == 1 && batch > 0 && delay_scale >= 0) {
+        int num_tas = atoi(args[0]);
+        if (num_tas < 1) {
+            std::cerr << "Error: Must have at least 1 TA\n";
+            return 1;
+        }
+        std::cout << "=== TA Marking System (distributed worker, " << num_tas << " TAs) ===\n";
+        return run_worker(address, num_tas, batch, delay_scale);
+    }
+
+    print_usage(argv[0]);
+    return 1;
+}
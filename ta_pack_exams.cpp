@@ -0,0 +1,30 @@
+/**
+ * @file ta_pack_exams.cpp
+ * @brief Packs a directory of exam_*.txt files into a single exam archive
+ * @author Student 1: Bhagya Patel (101324150)
+ * @author Student 2: Oluwatobi Olowookere (101245900)
+ *
+ * The archive can be passed to either engine instead of the exam files:
+ *   ./ta_pack_exams exams.archive
+ *   ./ta_marking_2b 3 exams.archive
+ */
+#include <iostream>
+#include <string>
+
+#include "exam_archive.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <output_archive> [exam_directory]\n";
+        return 1;
+    }
+
+    std::string dir = argc == 3 ? argv[2] : ".";
+    long packed = pack_exam_directory(dir, argv[1]);
+    if (packed < 0) {
+        return 1;
+    }
+    
+    std::cout << "Packed " << packed << " exams from " << dir << " into " << argv[1] << "\n";
+    return 0;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file ta_remote.h
+ * @brief Socket helpers and wire protocol for distributed marking
+ * @author Student 1: Bhagya Patel (101324150)
+ * @author Student 2: Oluwatobi Olowookere (101245900)
+ *
+ * Addresses are "unix:<path>" for a Unix domain socket, or "<host>:<port>"
+ * (optionally written "tcp:<host>:<port>") for TCP.
+ *
+ * The protocol is one text line per message, words separated by spaces.
+ * Questions are numbered from 1 on the wire.
+ *
+ *   Worker TA -> coordinator
+ *     HELLO <name>
+ *     LEASE <max_questions>                      ask for a batch of questions
+ *     RESULT <lease_id> <exam> <question> <rubric_version>
+ *     CORRECT <question> <rubric_version>        rubric correction, based on that version
+ *
+ *   Coordinator -> worker TA
+ *     WELCOME <ta_id> <lease_ms>
+ *     RUBRIC <version> <line>|<line>|...         sent on connect and after every correction
+ *     BATCH <lease_id> <exam>:<student>:<question> ...
+ *     WAIT <retry_ms>                            nothing to lease right now
+ *     DONE                                       every exam is marked, disconnect
+ *
+ * A lease that is not finished within lease_ms of being granted (or of its
+ * last RESULT) expires and its unfinished questions are handed out again.
+ */
+#ifndef TA_REMOTE_H
+#define TA_REMOTE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define REMOTE_MAX_LINE 65536
+#define REMOTE_RUBRIC_SEPARATOR '|'
+
+struct RemoteAddress {
+    bool is_unix;
+    std::string path;  // Unix socket path
+    std::string host;  // TCP host
+    std::string port;  // TCP port
+};
+
+// Parse "unix:<path>", "tcp:<host>:<port>" or "<host>:<port>"
+inline bool parse_remote_address(const std::string& text, RemoteAddress& address) {
+    address = RemoteAddress();
+    if (text.compare(0, 5, "unix:") == 0) {
+        address.is_unix = true;
+        address.path = text.substr(5);
+        return !address.path.empty() && address.path.size() < sizeof(sockaddr_un::sun_path);
+    }
+
+    std::string host_port = text.compare(0, 4, "tcp:") == 0 ? text.substr(4) : text;
+    size_t colon = host_port.rfind(':');
+    if (colon == std::string::npos || colon + 1 == host_port.size()) {
+        return false;
+    }
+    address.is_unix = false;
+    address.host = colon == 0 ? "0.0.0.0" : host_port.substr(0, colon);
+    address.port = host_port.substr(colon + 1);
+    return true;
+}
+
+// Create a listening socket. Returns -1 on error.
+inline int remote_listen(const RemoteAddress& address) {
+    if (address.is_unix) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd == -1) {
+            perror("socket");
+            return -1;
+        }
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, address.path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(address.path.c_str());  // Stale socket from an earlier run
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) == -1 || listen(fd, 64) == -1) {
+            perror(address.path.c_str());
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* result = nullptr;
+    int rc = getaddrinfo(address.host.c_str(), address.port.c_str(), &hints, &result);
+    if (rc != 0) {
+        std::cerr << "Error: " << address.host << ": " << gai_strerror(rc) << "\n";
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* ai = result; ai != nullptr && fd == -1; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd == -1) continue;
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) == -1 || listen(fd, 64) == -1) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+    if (fd == -1) {
+        perror(("listen " + address.host + ":" + address.port).c_str());
+    }
+    return fd;
+}
+
+// Connect to a coordinator. Returns -1 on error.
+inline int remote_connect(const RemoteAddress& address) {
+    if (address.is_unix) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd == -1) {
+            perror("socket");
+            return -1;
+        }
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, address.path.c_str(), sizeof(addr.sun_path) - 1);
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == -1) {
+            perror(address.path.c_str());
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    int rc = getaddrinfo(address.host.c_str(), address.port.c_str(), &hints, &result);
+    if (rc != 0) {
+        std::cerr << "Error: " << address.host << ": " << gai_strerror(rc) << "\n";
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* ai = result; ai != nullptr && fd == -1; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd == -1) continue;
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == -1) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+    if (fd == -1) {
+        perror(("connect " + address.host + ":" + address.port).c_str());
+        return -1;
+    }
+
+    // Messages are small request/response lines; don't let Nagle hold them back
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    return fd;
+}
+
+// Write a whole message (a newline is appended). Returns false if the peer is gone.
+inline bool remote_send(int fd, const std::string& message) {
+    std::string line = message + "\n";
+    size_t sent = 0;
+    while (sent < line.size()) {
+        ssize_t n = send(fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+// Take one complete line out of a receive buffer
+inline bool take_line(std::string& buffer, std::string& line) {
+    size_t newline = buffer.find('\n');
+    if (newline == std::string::npos) {
+        return false;
+    }
+    line = buffer.substr(0, newline);
+    buffer.erase(0, newline + 1);
+    return true;
+}
+
+// Blocking read of the next message. Returns false on EOF, error or an
+// over-long line.
+inline bool remote_receive(int fd, std::string& buffer, std::string& line) {
+    char chunk[4096];
+    while (!take_line(buffer, line)) {
+        if (buffer.size() > REMOTE_MAX_LINE) return false;
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buffer.append(chunk, n);
+    }
+    return true;
+}
+
+inline std::vector<std::string> split_words(const std::string& line) {
+    std::vector<std::string> words;
+    std::istringstream iss(line);
+    std::string word;
+    while (iss >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+// Rubric lines travel joined by REMOTE_RUBRIC_SEPARATOR on one message line
+inline std::string join_rubric(const std::vector<std::string>& lines) {
+    std::string joined;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (i > 0) joined += REMOTE_RUBRIC_SEPARATOR;
+        joined += lines[i];
+    }
+    return joined;
+}
+
+inline std::vector<std::string> split_rubric(const std::string& joined) {
+    std::vector<std::string> lines;
+    std::istringstream iss(joined);
+    std::string line;
+    while (std::getline(iss, line, REMOTE_RUBRIC_SEPARATOR)) {
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+#endif  // TA_REMOTE_H
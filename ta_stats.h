@@ -0,0 +1,172 @@
+/**
+ * @file ta_stats.h
+ * @brief Live statistics page exported by the marking engine and read by ta_top
+ * @author Student 1: Bhagya Patel (101324150)
+ * @author Student 2: Oluwatobi Olowookere (101245900)
+ *
+ * The page is a separate shared memory segment (/ta_marking_stats) from the
+ * engine's /ta_marking_shm. Each TA only writes its own slot and every field
+ * is a lock-free atomic, so the TAs never take a lock to publish and ta_top
+ * maps the page read-only: attaching a monitor cannot slow the workers down
+ * or corrupt their state. Readers may see fields from slightly different
+ * moments, which is fine for monitoring.
+ */
+#ifndef TA_STATS_H
+#define TA_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TA_STATS_SHM_NAME "/ta_marking_stats"
+#define TA_STATS_MAGIC "TASTATS"
+#define TA_STATS_VERSION 4
+#define TA_STATS_MAX_TAS 256
+#define TA_STATS_POLICY_SIZE 32
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LONG_LOCK_FREE == 2,
+              "the stats page needs lock-free atomics to be shared between processes");
+
+// What a TA is doing right now
+enum TaState {
+    TA_STATE_STOPPED = 0,      // Not started yet, finished or retired
+    TA_STATE_READING_RUBRIC,
+    TA_STATE_CORRECTING_RUBRIC,
+    TA_STATE_FINDING_EXAM,
+    TA_STATE_LOADING_EXAM,
+    TA_STATE_MARKING,
+    TA_STATE_RESTING,          // Short pause between steps
+    TA_STATE_REMARKING,        // Marking again after a rubric correction
+};
+
+static const char* const TA_STATE_NAMES[] = {
+    "stopped", "reading_rubric", "correcting_rubric", "finding_exam",
+    "loading_exam", "marking", "resting", "remarking",
+};
+
+// Lock a TA is blocked on
+enum StatsLock {
+    STATS_LOCK_NONE = 0,
+    STATS_LOCK_RUBRIC,
+    STATS_LOCK_READER_COUNT,
+    STATS_LOCK_EXAM_LOAD,
+    STATS_LOCK_EXAM,
+};
+
+static const char* const STATS_LOCK_NAMES[] = {
+    "", "rubric", "reader_count", "exam_load", "exam",
+};
+
+// One TA's counters, written only by that TA (slot 0 is the supervisor). Each
+// slot has its own cache lines so TAs never write to a line another TA writes.
+struct alignas(64) TaStatsSlot {
+    std::atomic<int> pid;
+    std::atomic<int> state;             // TaState
+    std::atomic<int> blocked_on;        // StatsLock, STATS_LOCK_NONE when running
+    std::atomic<int> student_number;    // Exam being marked (0 = none)
+    std::atomic<int> question;          // Question being marked, 1-based (0 = none)
+    std::atomic<long> state_since_us;   // Monotonic time the state last changed
+    std::atomic<long> questions_marked;
+    std::atomic<long> exams_completed;  // Exams whose last question this TA marked
+    std::atomic<long> questions_remarked; // Re-marks of marks a rubric correction made stale
+    std::atomic<long> lock_acquires;
+    std::atomic<long> lock_waits;       // Acquires that had to block
+};
+
+struct TaStatsPage {
+    char magic[8];                      // TA_STATS_MAGIC, written last
+    uint32_t version;                   // TA_STATS_VERSION
+    int32_t engine_pid;
+    int32_t max_tas;
+    char policy[TA_STATS_POLICY_SIZE];
+    long start_us;                      // Monotonic time marking started
+    std::atomic<int> active_tas;
+    std::atomic<int> all_done;
+    std::atomic<int> exams_known;       // Exam files / archive entries found so far
+    std::atomic<int> exams_loaded;
+    std::atomic<int> loader_queue;      // Exams waiting to be loaded
+    std::atomic<long> rubric_version;   // Number of rubric corrections so far
+    TaStatsSlot tas[TA_STATS_MAX_TAS + 1];  // Totals are the sums over the slots
+};
+
+// Monotonic clock in microseconds
+inline long stats_now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+// Create (replacing any stale one) and map the stats page for writing.
+// Returns NULL on error; the engine then simply runs without stats.
+inline TaStatsPage* create_stats_page(int max_tas, const char* policy) {
+    shm_unlink(TA_STATS_SHM_NAME);
+    int fd = shm_open(TA_STATS_SHM_NAME, O_CREAT | O_RDWR, 0644);
+    if (fd == -1) {
+        perror("shm_open " TA_STATS_SHM_NAME);
+        return nullptr;
+    }
+    if (ftruncate(fd, sizeof(TaStatsPage)) == -1) {
+        perror("ftruncate " TA_STATS_SHM_NAME);
+        close(fd);
+        return nullptr;
+    }
+    void* base = mmap(NULL, sizeof(TaStatsPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap " TA_STATS_SHM_NAME);
+        return nullptr;
+    }
+
+    // A fresh segment is zero-filled, which is every counter's initial value
+    TaStatsPage* page = (TaStatsPage*)base;
+    page->version = TA_STATS_VERSION;
+    page->engine_pid = getpid();
+    page->max_tas = max_tas;
+    strncpy(page->policy, policy, TA_STATS_POLICY_SIZE - 1);
+    page->start_us = stats_now_us();
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(page->magic, TA_STATS_MAGIC, sizeof(page->magic));
+    return page;
+}
+
+// Map the current stats page read-only. Returns NULL if no engine has one
+// (yet). inode identifies the segment so a monitor can notice a new run.
+inline const TaStatsPage* attach_stats_page(ino_t& inode) {
+    int fd = shm_open(TA_STATS_SHM_NAME, O_RDONLY, 0);
+    if (fd == -1) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(TaStatsPage)) {
+        close(fd);
+        return nullptr;
+    }
+    void* base = mmap(NULL, sizeof(TaStatsPage), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+
+    const TaStatsPage* page = (const TaStatsPage*)base;
+    if (memcmp(page->magic, TA_STATS_MAGIC, sizeof(page->magic)) != 0 ||
+        page->version != TA_STATS_VERSION) {
+        munmap(base, sizeof(TaStatsPage));
+        return nullptr;
+    }
+    inode = st.st_ino;
+    return page;
+}
+
+inline void close_stats_page(const TaStatsPage* page) {
+    if (page != nullptr) {
+        munmap((void*)page, sizeof(TaStatsPage));
+    }
+}
+
+#endif  // TA_STATS_H
@@ -0,0 +1,192 @@
+/**
+ * @file ta_top.cpp
+ * @brief Live monitor for a running marking engine (Part A, Part B or lock-free)
+ * @author Student 1: Bhagya Patel (101324150)
+ * @author Student 2: Oluwatobi Olowookere (101245900)
+ *
+ * Attaches read-only to the /ta_marking_stats page (see ta_stats.h) and
+ * redraws it every interval: what each TA is doing, which lock it is blocked
+ * on, how long it has been in that state, and questions/s. It never takes
+ * the engine's locks, so it can be left running against a busy engine.
+ *
+ *   g++ -o ta_top ta_top.cpp -std=c++11 -lrt
+ *   ./ta_top            # Refresh every second until Ctrl+C
+ *   ./ta_top -n 1       # Print one snapshot (rates over one interval) and exit
+ */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "ta_stats.h"
+
+// Questions marked at one moment, for per-interval rates
+struct Sample {
+    long time_us;
+    long total_marked;
+    long ta_marked[TA_STATS_MAX_TAS + 1];
+};
+
+// Read the counters rates are measured with. Totals are kept per TA, so no
+// counter is shared between TAs.
+void take_sample(const TaStatsPage* page, Sample& sample) {
+    sample.time_us = stats_now_us();
+    sample.total_marked = 0;
+    for (int ta_id = 0; ta_id <= page->max_tas && ta_id <= TA_STATS_MAX_TAS; ta_id++) {
+        sample.ta_marked[ta_id] = page->tas[ta_id].questions_marked.load(std::memory_order_relaxed);
+        sample.total_marked += sample.ta_marked[ta_id];
+    }
+}
+
+// Rate since the previous sample, or "-" when there is none yet
+std::string rate(long now, long before, long elapsed_us) {
+    if (elapsed_us <= 0) return "-";
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << (now - before) * 1e6 / elapsed_us;
+    return out.str();
+}
+
+void print_page(const TaStatsPage* page, Sample& prev, bool clear_screen) {
+    Sample sample;
+    take_sample(page, sample);
+    long now_us = sample.time_us;
+    long elapsed_us = prev.time_us > 0 ? now_us - prev.time_us : 0;
+    double uptime = (now_us - page->start_us) / 1e6;
+
+    long total_marked = sample.total_marked, exams_completed = 0, remarked = 0;
+    for (int ta_id = 0; ta_id <= page->max_tas && ta_id <= TA_STATS_MAX_TAS; ta_id++) {
+        exams_completed += page->tas[ta_id].exams_completed.load(std::memory_order_relaxed);
+        remarked += page->tas[ta_id].questions_remarked.load(std::memory_order_relaxed);
+    }
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << "ta_top - engine pid " << page->engine_pid << ", policy " << page->policy
+        << ", up " << uptime << "s, " << page->active_tas.load(std::memory_order_relaxed)
+        << " active TAs" << (page->all_done.load(std::memory_order_relaxed) ? " (done)" : "")
+        << "\n";
+    out << "Exams: " << page->exams_loaded.load(std::memory_order_relaxed) << "/"
+        << page->exams_known.load(std::memory_order_relaxed) << " loaded, "
+        << exams_completed << " fully marked, "
+        << "loader queue " << page->loader_queue.load(std::memory_order_relaxed)
+        << "   Rubric version " << page->rubric_version.load(std::memory_order_relaxed) << "\n";
+    out << "Questions: " << total_marked << " marked, "
+        << rate(total_marked, prev.total_marked, elapsed_us) << "/s now, "
+        << (uptime > 0 ? total_marked / uptime : 0.0) << "/s average, "
+        << remarked << " re-marked\n\n";
+
+    out << std::setw(4) << "TA" << std::setw(8) << "PID" << "  " << std::left
+        << std::setw(18) << "STATE" << std::setw(14) << "BLOCKED_ON" << std::right
+        << std::setw(8) << "STUDENT" << std::setw(3) << "Q" << std::setw(8) << "MARKED"
+        << std::setw(7) << "Q/S" << std::setw(9) << "LOCKS" << std::setw(8) << "WAITS"
+        << std::setw(9) << "STATE_S" << "\n";
+
+    for (int ta_id = 1; ta_id <= page->max_tas && ta_id <= TA_STATS_MAX_TAS; ta_id++) {
+        const TaStatsSlot& slot = page->tas[ta_id];
+        int pid = slot.pid.load(std::memory_order_relaxed);
+        if (pid == 0) continue;  // Never started
+
+        int state = slot.state.load(std::memory_order_relaxed);
+        int blocked_on = slot.blocked_on.load(std::memory_order_relaxed);
+        int student = slot.student_number.load(std::memory_order_relaxed);
+        int question = slot.question.load(std::memory_order_relaxed);
+        long marked = sample.ta_marked[ta_id];
+        long since_us = slot.state_since_us.load(std::memory_order_relaxed);
+        if (state < TA_STATE_STOPPED || state > TA_STATE_REMARKING) state = TA_STATE_STOPPED;
+        if (blocked_on < STATS_LOCK_NONE || blocked_on > STATS_LOCK_EXAM) {
+            blocked_on = STATS_LOCK_NONE;
+        }
+
+        out << std::setw(4) << ta_id << std::setw(8) << pid << "  " << std::left
+            << std::setw(18) << TA_STATE_NAMES[state] << std::setw(14)
+            << STATS_LOCK_NAMES[blocked_on] << std::right << std::setw(8);
+        if (student != 0) {
+            out << student << std::setw(3) << question;
+        } else {
+            out << "-" << std::setw(3) << "-";
+        }
+        out << std::setw(8) << marked << std::setw(7)
+            << rate(marked, prev.ta_marked[ta_id], elapsed_us)
+            << std::setw(9) << slot.lock_acquires.load(std::memory_order_relaxed)
+            << std::setw(8) << slot.lock_waits.load(std::memory_order_relaxed)
+            << std::setw(9) << (since_us > 0 ? std::max(0L, now_us - since_us) / 1e6 : 0.0) << "\n";
+    }
+
+    prev = sample;
+
+    if (clear_screen) {
+        std::cout << "\033[H\033[2J";
+    }
+    std::cout << out.str() << std::flush;
+}
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [-d seconds] [-n iterations]\n"
+              << "  -d SEC   refresh interval (default: 1)\n"
+              << "  -n N     exit after N refreshes (default: run until Ctrl+C)\n";
+}
+
+int main(int argc, char* argv[]) {
+    double interval = 1.0;
+    long iterations = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            interval = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = atol(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (interval <= 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Only clear the screen when refreshing interactively
+    bool clear_screen = iterations != 1 && isatty(STDOUT_FILENO);
+
+    const TaStatsPage* page = nullptr;
+    ino_t inode = 0;
+    Sample prev;
+    memset(&prev, 0, sizeof(prev));
+
+    for (long n = 0; iterations == 0 || n < iterations; n++) {
+        // Re-attach when a new run has replaced the page (or there was none)
+        ino_t latest = 0;
+        const TaStatsPage* fresh = attach_stats_page(latest);
+        if (fresh != nullptr && (page == nullptr || latest != inode)) {
+            close_stats_page(page);
+            page = fresh;
+            inode = latest;
+            memset(&prev, 0, sizeof(prev));
+        } else {
+            close_stats_page(fresh);
+        }
+
+        // A single snapshot has no earlier refresh to take rates from, so
+        // sample once and print one interval later
+        if (page != nullptr && iterations == 1) {
+            take_sample(page, prev);
+            usleep((useconds_t)(interval * 1000000));
+        }
+
+        if (page != nullptr) {
+            print_page(page, prev, clear_screen);
+        } else {
+            std::cout << "ta_top - waiting for a marking engine (" << TA_STATS_SHM_NAME
+                      << " not found)\n" << std::flush;
+        }
+
+        if (iterations == 0 || n + 1 < iterations) {
+            usleep((useconds_t)(interval * 1000000));
+        }
+    }
+
+    close_stats_page(page);
+    return 0;
+}